@@ -0,0 +1,356 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <regex>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+    // The result of one benchmark, at one arg.
+    struct BenchmarkResult
+    {
+        std::string m_Name;             // "Fixture/Method/arg"
+        uint64_t m_Iterations;
+        double m_NsPerIteration;
+        double m_ItemsPerSec;           // 0 => not reported
+        std::string m_Label;            // empty => not reported
+        std::string m_Error;            // empty => no error
+    };
+
+    // Runs the fixture's benchmark with more and more iterations until it 
+    // takes at least minTime, in the manner of Google Benchmark.
+    BenchmarkResult runOne(BenchmarkFixture& fixture, int arg, double minTime)
+    {
+        static const uint64_t s_MaxIterations = 1000000000;
+
+        uint64_t numIterations = 1;
+        while (true)
+        {
+            BenchmarkState state(arg, numIterations);
+            fixture.run(state);
+
+            const double elapsed = state.getElapsedSec();
+            if ((elapsed >= minTime) || (numIterations >= s_MaxIterations))
+            {
+                BenchmarkResult result;
+                result.m_Iterations = state.getIterations();
+                result.m_NsPerIteration = (result.m_Iterations > 0)
+                    ? (elapsed * 1e9) / (double)result.m_Iterations : 0.0;
+                result.m_ItemsPerSec = ((state.getItemsProcessed() > 0) && (elapsed > 0.0))
+                    ? (double)state.getItemsProcessed() / elapsed : 0.0;
+                result.m_Label = state.getLabel();
+                result.m_Error = state.getError();
+                return result;
+            }
+
+            // Aim a bit past the minimum time, but don't grow by more than 10x
+            // at a time, in case the first runs were dominated by noise.
+            double multiplier = (elapsed > 0.0) ? (minTime * 1.4) / elapsed : 10.0;
+            multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+            numIterations = std::min((uint64_t)((double)numIterations * multiplier), s_MaxIterations);
+        }
+    }
+
+    void printConsoleHeader()
+    {
+        printf("%-40s %16s %12s %16s\n", "Benchmark", "Time (ns)", "Iterations", "Items/sec");
+    }
+
+    void printConsoleRow(const BenchmarkResult& result)
+    {
+        if (result.m_ItemsPerSec > 0.0)
+        {
+            printf("%-40s %16.0f %12llu %16.0f", result.m_Name.c_str(), result.m_NsPerIteration,
+                   (unsigned long long)result.m_Iterations, result.m_ItemsPerSec);
+        }
+        else
+        {
+            printf("%-40s %16.0f %12llu %16s", result.m_Name.c_str(), result.m_NsPerIteration,
+                   (unsigned long long)result.m_Iterations, "");
+        }
+        if (!result.m_Label.empty())
+        {
+            printf(" %s", result.m_Label.c_str());
+        }
+        if (!result.m_Error.empty())
+        {
+            printf(" ERROR: %s", result.m_Error.c_str());
+        }
+        printf("\n");
+    }
+
+    // printf onto the end of a string.
+    void appendf(std::string& out, const char* format, ...)
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        out += buffer;
+    }
+
+    // The same layout as Google Benchmark's JSON reporter.  NOTE: the names
+    // are made of identifiers and numbers, and the labels are our own, so 
+    // there's nothing to escape.
+    std::string formatJson(const std::vector<BenchmarkResult>& results)
+    {
+        const time_t now = time(NULL);
+        struct tm local;
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char date[64];
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local);
+
+        std::string json;
+        appendf(json, "{\n");
+        appendf(json, "  \"context\": {\n");
+        appendf(json, "    \"date\": \"%s\",\n", date);
+        appendf(json, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+        appendf(json, "    \"library_build_type\": \"release\"\n");
+#else
+        appendf(json, "    \"library_build_type\": \"debug\"\n");
+#endif
+        appendf(json, "  },\n");
+        appendf(json, "  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchmarkResult& result = results[i];
+            appendf(json, "    {\n");
+            appendf(json, "      \"name\": \"%s\",\n", result.m_Name.c_str());
+            appendf(json, "      \"run_type\": \"iteration\",\n");
+            appendf(json, "      \"iterations\": %llu,\n", (unsigned long long)result.m_Iterations);
+            appendf(json, "      \"real_time\": %.3f,\n", result.m_NsPerIteration);
+            if (result.m_ItemsPerSec > 0.0)
+            {
+                appendf(json, "      \"items_per_second\": %.3f,\n", result.m_ItemsPerSec);
+            }
+            if (!result.m_Label.empty())
+            {
+                appendf(json, "      \"label\": \"%s\",\n", result.m_Label.c_str());
+            }
+            if (!result.m_Error.empty())
+            {
+                appendf(json, "      \"error_occurred\": true,\n");
+                appendf(json, "      \"error_message\": \"%s\",\n", result.m_Error.c_str());
+            }
+            appendf(json, "      \"time_unit\": \"ns\"\n");
+            appendf(json, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+        }
+        appendf(json, "  ]\n");
+        appendf(json, "}\n");
+        return json;
+    }
+
+    // Returns the value if arg is "<name>=<value>", or NULL.
+    const char* getFlagValue(const char* arg, const char* name)
+    {
+        const size_t len = strlen(name);
+        if ((strncmp(arg, name, len) == 0) && (arg[len] == '='))
+        {
+            return arg + len + 1;
+        }
+        return NULL;
+    }
+}
+
+void doNotOptimize(uint64_t value)
+{
+    static volatile uint64_t s_Sink = 0;
+    s_Sink = value;
+}
+
+BenchmarkState::BenchmarkState(int arg, uint64_t maxIterations)
+    : m_Arg(arg)
+    , m_MaxIterations(maxIterations)
+    , m_Iterations(0)
+    , m_ItemsProcessed(0)
+    , m_bRunning(false)
+    , m_ElapsedSec(0.0)
+{
+}
+
+void BenchmarkState::pauseTiming()
+{
+    if (m_bRunning)
+    {
+        m_ElapsedSec += std::chrono::duration<double>(Clock::now() - m_StartTime).count();
+        m_bRunning = false;
+    }
+}
+
+void BenchmarkState::resumeTiming()
+{
+    if (!m_bRunning)
+    {
+        m_bRunning = true;
+        m_StartTime = Clock::now();
+    }
+}
+
+BenchmarkRegistry& BenchmarkRegistry::get()
+{
+    // Function-local, so that it exists before the first BENCHMARK_F 
+    // registers itself, whichever file that's in.
+    static BenchmarkRegistry s_Registry;
+    return s_Registry;
+}
+
+bool BenchmarkRegistry::add(const char* fixtureName, const char* methodName, const Factory& makeFixture)
+{
+    Entry entry;
+    entry.m_Name = std::string(fixtureName) + "/" + methodName;
+    entry.m_MakeFixture = makeFixture;
+    m_Entries.push_back(entry);
+    return true;
+}
+
+int runBenchmarks(int argc, char* argv[])
+{
+    std::string filter = ".*";
+    double minTime = 0.5;
+    bool bJson = false;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pValue = NULL;
+        if ((pValue = getFlagValue(argv[i], "--benchmark_filter")) != NULL)
+        {
+            filter = pValue;
+        }
+        else if ((pValue = getFlagValue(argv[i], "--benchmark_min_time")) != NULL)
+        {
+            minTime = atof(pValue);
+        }
+        else if ((pValue = getFlagValue(argv[i], "--benchmark_format")) != NULL)
+        {
+            if (strcmp(pValue, "json") == 0)
+            {
+                bJson = true;
+            }
+            else if (strcmp(pValue, "console") != 0)
+            {
+                printf("Unknown benchmark format '%s' (expected console or json).\n", pValue);
+                return 1;
+            }
+        }
+        else if ((pValue = getFlagValue(argv[i], "--benchmark_out")) != NULL)
+        {
+            outPath = pValue;
+        }
+        else
+        {
+            printf("Unknown argument '%s'.\n", argv[i]);
+            printf("Usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<sec>]\n", argv[0]);
+            printf("       [--benchmark_format=console|json] [--benchmark_out=<path>]\n");
+            return 1;
+        }
+    }
+
+    std::regex filterRegex;
+    try
+    {
+        filterRegex = std::regex(filter);
+    }
+    catch (const std::regex_error&)
+    {
+        printf("Invalid benchmark filter '%s'.\n", filter.c_str());
+        return 1;
+    }
+
+    if (!bJson)
+    {
+        printConsoleHeader();
+    }
+
+    std::vector<BenchmarkResult> results;
+    unsigned int numErrors = 0;
+    for (const BenchmarkRegistry::Entry& entry : BenchmarkRegistry::get().getEntries())
+    {
+        BenchmarkFixture* pFixture = entry.m_MakeFixture();
+        const std::vector<int> args = pFixture->getArgs();
+        for (int arg : args)
+        {
+            const std::string name = entry.m_Name + "/" + std::to_string(arg);
+            if (!std::regex_search(name, filterRegex))
+            {
+                continue;
+            }
+
+            pFixture->setUp(arg);
+            BenchmarkResult result = runOne(*pFixture, arg, minTime);
+            pFixture->tearDown();
+
+            result.m_Name = name;
+            results.push_back(result);
+            numErrors += result.m_Error.empty() ? 0 : 1;
+
+            // Print as we go, since the big worlds are slow.
+            if (!bJson)
+            {
+                printConsoleRow(result);
+                fflush(stdout);
+            }
+        }
+        delete pFixture;
+    }
+
+    const std::string json = formatJson(results);
+    if (bJson)
+    {
+        fputs(json.c_str(), stdout);
+    }
+
+    if (!outPath.empty())
+    {
+        std::ofstream file(outPath.c_str(), std::ios::trunc);
+        file << json;
+        if (!file)
+        {
+            printf("Couldn't write benchmark results to '%s'.\n", outPath.c_str());
+            return 1;
+        }
+    }
+
+    if (numErrors > 0)
+    {
+        // NOTE: to stderr, so that it doesn't break the JSON on stdout.
+        fprintf(stderr, "%u benchmark run(s) failed.\n", numErrors);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// A small benchmark harness, laid out like Google Benchmark (fixtures, a 
+// State that drives the timed loop, JSON output) so that the results can go 
+// through the same tools.  We don't pull in the library itself because the 
+// project doesn't carry any other external dependencies but SDL.
+//
+// Usage:
+//   class MyFixture : public BenchmarkFixture { ... setUp(), tearDown(), getArgs() ... };
+//
+//   BENCHMARK_F(MyFixture, DoThing)
+//   {
+//       while (state.keepRunning())
+//       {
+//           doThing();
+//       }
+//   }
+//
+// Each benchmark is run once for each of the fixture's args, with the 
+// iteration count raised until the timed loop takes at least the minimum time.
+
+// Drives one run of a benchmark's timed loop.
+class BenchmarkState
+{
+public:
+    BenchmarkState(int arg, uint64_t maxIterations);
+
+    int getArg() const { return m_Arg; }
+
+    // Returns true until the loop has run the required number of iterations.
+    // The clock runs from the first call to the last.
+    bool keepRunning()
+    {
+        if (m_Iterations == 0)
+        {
+            m_bRunning = true;
+            m_StartTime = Clock::now();
+        }
+        if (m_Iterations < m_MaxIterations)
+        {
+            ++m_Iterations;
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    // Excludes work (such as restoring a world) from the timing.
+    void pauseTiming();
+    void resumeTiming();
+
+    // Reported as items_per_second, if set.
+    void setItemsProcessed(uint64_t numItems) { m_ItemsProcessed = numItems; }
+
+    // Free text reported with the result, if set - e.g. how accurate an 
+    // approximation was.  NOTE: it goes into the JSON as is, so no quotes.
+    void setLabel(const std::string& label) { m_Label = label; }
+
+    // Marks the run as failed - e.g. a check it makes along the way didn't 
+    // hold.  The run is still timed and reported, but runBenchmarks() returns
+    // an error.  NOTE: the message goes into the JSON as is, so no quotes.
+    void setError(const std::string& message) { m_Error = message; }
+
+    uint64_t getIterations() const { return m_Iterations; }
+    double getElapsedSec() const { return m_ElapsedSec; }
+    uint64_t getItemsProcessed() const { return m_ItemsProcessed; }
+    const std::string& getLabel() const { return m_Label; }
+    bool hasError() const { return !m_Error.empty(); }
+    const std::string& getError() const { return m_Error; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    int m_Arg;
+    uint64_t m_MaxIterations;
+    uint64_t m_Iterations;
+    uint64_t m_ItemsProcessed;
+    std::string m_Label;
+    std::string m_Error;                // empty => no error
+
+    bool m_bRunning;
+    Clock::time_point m_StartTime;
+    double m_ElapsedSec;
+};
+
+// Hands a result to the outside world, so that the work that went into it 
+// can't be optimized away.
+void doNotOptimize(uint64_t value);
+
+// The world that a group of benchmarks run in.  setUp() is called before 
+// each run (with the arg the run is for), and tearDown() after.
+class BenchmarkFixture
+{
+public:
+    virtual ~BenchmarkFixture() {}
+
+    virtual std::vector<int> getArgs() const { return std::vector<int>(1, 0); }
+    virtual void setUp(int arg) {}
+    virtual void tearDown() {}
+
+    virtual void run(BenchmarkState& state) = 0;
+};
+
+// Every benchmark in the program, in the order they were defined.
+class BenchmarkRegistry
+{
+public:
+    typedef std::function<BenchmarkFixture*()> Factory;
+
+    struct Entry
+    {
+        std::string m_Name;             // "Fixture/Method"
+        Factory m_MakeFixture;
+    };
+
+    static BenchmarkRegistry& get();
+
+    // Returns true, so that it can initialize a static (see BENCHMARK_F).
+    bool add(const char* fixtureName, const char* methodName, const Factory& makeFixture);
+
+    const std::vector<Entry>& getEntries() const { return m_Entries; }
+
+private:
+    std::vector<Entry> m_Entries;
+};
+
+// Defines a benchmark as a method of a fixture.  The body gets a 
+// BenchmarkState& called state.
+#define BENCHMARK_F(Fixture, Method)                                                    \
+    class Fixture##_##Method##_Benchmark : public Fixture                               \
+    {                                                                                   \
+    public:                                                                             \
+        virtual void run(BenchmarkState& state);                                        \
+    };                                                                                  \
+    static const bool s_b##Fixture##_##Method##_Registered = BenchmarkRegistry::get().add( \
+        #Fixture, #Method, []() -> BenchmarkFixture* { return new Fixture##_##Method##_Benchmark; }); \
+    void Fixture##_##Method##_Benchmark::run(BenchmarkState& state)
+
+// Runs the registered benchmarks, as directed by the command line, and 
+// reports the results.  Returns the process exit code, which is non-zero if 
+// any benchmark flagged an error (see BenchmarkState::setError()).
+//   --benchmark_filter=<regex>      only run benchmarks whose name matches
+//   --benchmark_min_time=<sec>      minimum time for each run (default 0.5)
+//   --benchmark_format=console|json what to print to stdout
+//   --benchmark_out=<path>          also write the results (as JSON) to a file
+int runBenchmarks(int argc, char* argv[]);
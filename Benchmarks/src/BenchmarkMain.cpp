@@ -0,0 +1,45 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+
+#include "Log.h"
+
+// Runs the micro benchmarks (see Benchmark.h for the options), for example:
+//   Benchmarks --benchmark_filter=SimWorld/GameTick --benchmark_format=json
+int main(int argc, char* argv[])
+{
+    // Make sure the log exists before any threads start using it, since 
+    // Singleton::get() isn't thread safe.
+    Log::get();
+
+    int result = 0;
+    {
+        // Keep the game's warnings (placement, etc.) out of the timings and 
+        // the output.
+        Log::ScopedMute mute;
+        result = runBenchmarks(argc, argv);
+    }
+
+    Log::shutdown();
+    return result;
+}
@@ -0,0 +1,631 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+
+#include "Constants.h"
+#include "Game.h"
+#include "GameSnapshot.h"
+#include "Mob.h"
+#include "Occluders.h"
+#include "Player.h"
+#include "TowerVisibility.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Reaches the protected parts of the game that we time directly.  Mob and 
+// Game name this as a friend.
+struct BenchmarkAccess
+{
+    static void pickTarget(Mob& mob)
+    {
+        // Drop any lock, so that every call does the full search.
+        mob.m_bTargetLock = false;
+        mob.pickTarget();
+    }
+
+    static bool isHiding(const Mob& mob) { return mob.isHiding(); }
+    static void move(Mob& mob, float deltaTSec) { mob.move(deltaTSec); }
+
+    static bool lineSquareIntersection(const Mob& mob, const Vec2& start, float size, const Vec2& objPos)
+    {
+        return mob.lineSquareIntersection(start, size, objPos);
+    }
+
+    // The same, from start to end rather than to the mob.
+    static bool lineSquareIntersection(Mob& mob, const Vec2& start, const Vec2& end, float size, const Vec2& objPos)
+    {
+        const Vec2 oldPos = mob.pos();
+        mob.pos() = end;
+        const bool bHit = mob.lineSquareIntersection(start, size, objPos);
+        mob.pos() = oldPos;
+        return bHit;
+    }
+
+    // Puts the per-tick caches (the occluders and the mob grids) and the 
+    // frame arenas into the state they'd be in part way through a tick, so 
+    // that the queries above can be called on their own.
+    static void prepareQueries(Game& game)
+    {
+        game.m_pNorthPlayer->updateOccluders();
+        game.m_pSouthPlayer->updateOccluders();
+        game.m_NorthMobGrid.rebuild(game.m_pNorthPlayer->getMobStore());
+        game.m_SouthMobGrid.rebuild(game.m_pSouthPlayer->getMobStore());
+        for (FrameArena* pArena : game.m_FrameArenas)
+        {
+            pArena->reset();
+        }
+    }
+};
+
+namespace
+{
+    // A world with a scripted army on each side: arg mobs in all, split
+    // evenly between the players, of every type in turn, scattered over each
+    // player's half of the board (South's army is North's, mirrored).  The 
+    // world is ticked once before we start, so that targets, hiding and 
+    // collisions are all in the state they would be in mid-battle.
+    class SimWorld : public BenchmarkFixture
+    {
+    public:
+        SimWorld() : m_pGame(NULL) {}
+        virtual ~SimWorld() { delete m_pGame; }
+
+        virtual std::vector<int> getArgs() const
+        {
+            static const int s_Args[] = { 10, 100, 1000, 10000 };
+            return std::vector<int>(s_Args, s_Args + (sizeof(s_Args) / sizeof(s_Args[0])));
+        }
+
+        virtual void setUp(int numMobs)
+        {
+            delete m_pGame;
+            m_pGame = new Game(NULL, NULL);
+
+            GameSnapshot empty;
+            m_pGame->takeSnapshot(empty);
+
+            GameSnapshot world;
+            world.m_GameOverState = empty.m_GameOverState;
+            world.m_NextEntityId = empty.m_NextEntityId;
+            addArmy(empty, true, numMobs / 2, world);
+            addArmy(empty, false, numMobs - (numMobs / 2), world);
+
+            m_pGame->restore(world);
+            m_pGame->tick(TICK_MIN);
+            m_pGame->takeSnapshot(m_Settled);
+
+            BenchmarkAccess::prepareQueries(*m_pGame);
+        }
+
+        virtual void tearDown()
+        {
+            delete m_pGame;
+            m_pGame = NULL;
+        }
+
+    protected:
+        // Puts the world back the way it was after setUp().  Call this with 
+        // the timing paused.
+        void reset()
+        {
+            m_pGame->restore(m_Settled);
+            BenchmarkAccess::prepareQueries(*m_pGame);
+        }
+
+        // A line of sight test that a hiding check would make: from an 
+        // opposing entity to a mob within its sight radius, against the mob's
+        // own player's occluders.
+        struct SightLine
+        {
+            Vec2 m_Start;
+            Vec2 m_End;
+            const Occluders* m_pOccluders;
+            const TowerVisibility* m_pTowerVisibility;
+        };
+
+        // Every sight line in the world (not just the Rogues', so that there's
+        // a decent sample), North's mobs first.
+        std::vector<SightLine> getSightLines() const
+        {
+            std::vector<SightLine> lines;
+            for (const Mob* pMob : getMobs())
+            {
+                const Player& friendlyPlayer = m_pGame->getPlayer(pMob->isNorth());
+                const Player& opposingPlayer = m_pGame->getPlayer(!pMob->isNorth());
+                for (int i = 0; i < 2; ++i)
+                {
+                    const std::vector<Entity*>& entities = (i == 0) ? opposingPlayer.getMobs() : opposingPlayer.getBuildings();
+                    for (const Entity* pEntity : entities)
+                    {
+                        const float sightRadius = pEntity->getStatsData().m_SightRadius;
+                        if (!pEntity->isDead() && 
+                            (pMob->getPosition().distSqr(pEntity->getPosition()) <= (sightRadius * sightRadius)))
+                        {
+                            SightLine line;
+                            line.m_Start = pEntity->getPosition();
+                            line.m_End = pMob->getPosition();
+                            line.m_pOccluders = &friendlyPlayer.getOccluders();
+                            line.m_pTowerVisibility = &friendlyPlayer.getTowerVisibility();
+                            lines.push_back(line);
+                        }
+                    }
+                }
+            }
+            return lines;
+        }
+
+        // The mobs of both players, North's first.
+        std::vector<Mob*> getMobs() const
+        {
+            std::vector<Mob*> mobs;
+            for (int i = 0; i < 2; ++i)
+            {
+                for (Entity* pEntity : m_pGame->getPlayer(i == 0).getMobs())
+                {
+                    mobs.push_back(static_cast<Mob*>(pEntity));
+                }
+            }
+            return mobs;
+        }
+
+    private:
+        // Appends one player's buildings (from the empty game) and then 
+        // numMobs new mobs to the world.
+        static void addArmy(const GameSnapshot& empty, bool bNorth, int numMobs, GameSnapshot& world)
+        {
+            const PlayerSnapshot& emptyPlayer = empty.getPlayer(bNorth);
+            PlayerSnapshot& player = world.getPlayer(bNorth);
+            player = emptyPlayer;
+            player.m_FirstEntity = (unsigned int)world.m_Entities.size();
+            player.m_NumMobs = (unsigned int)numMobs;
+            player.m_NextMobGeneration = 1;         // the mobs below are all generation 0
+
+            world.m_Entities.insert(world.m_Entities.end(),
+                                    empty.m_Entities.begin() + emptyPlayer.m_FirstEntity,
+                                    empty.m_Entities.begin() + emptyPlayer.m_FirstEntity + emptyPlayer.m_NumBuildings);
+
+            // The same sequence for both players, so that the armies mirror 
+            // each other.
+            unsigned int seed = 12345;
+            for (int i = 0; i < numMobs; ++i)
+            {
+                const iEntityStats::MobType type = (iEntityStats::MobType)(i % 4);
+                const float x = 1.f + (randomFraction(seed) * (GAME_GRID_WIDTH - 2.f));
+                const float y = 1.f + (randomFraction(seed) * (RIVER_TOP_Y - 2.f));
+
+                EntitySnapshot mob;
+                mob.m_Handle = EntityHandle(bNorth, false, (unsigned int)i, 0);
+                mob.m_Id = world.m_NextEntityId++;
+                mob.m_StatsIndex = (int)type;
+                mob.m_Pos = Vec2(x, bNorth ? y : (GAME_GRID_HEIGHT - y));
+                mob.m_Health = iEntityStats::getStats(type).getMaxHealth();
+                mob.m_Target = EntityHandle();
+                mob.m_TimeSinceAttack = 0.f;
+                mob.m_bHidden = false;
+                mob.m_bTargetLock = false;
+                mob.m_bInSpringAttackRange = false;
+                mob.m_TimeHiding = 0.f;
+                mob.m_bFollowingGiant = false;
+                mob.m_bFollowingBuilding = false;
+                mob.m_FriendlyGiant = EntityHandle();
+                mob.m_FriendlyBuilding = EntityHandle();
+                world.m_Entities.push_back(mob);
+            }
+        }
+
+    protected:
+        // A small LCG, so that every run (and platform) builds the same world.
+        static float randomFraction(unsigned int& seed)
+        {
+            seed = (seed * 1664525u) + 1013904223u;
+            return (float)(seed >> 8) / (float)(1u << 24);
+        }
+
+    protected:
+        Game* m_pGame;
+        GameSnapshot m_Settled;
+    };
+
+    // Layouts of arg boxes, of random sizes, scattered over the board, with
+    // random segments across each.  This is for checking the line of sight
+    // kernels against Mob::lineSquareIntersection() on far more (and more 
+    // awkward) lines than a match throws up.  The world is only there to lend
+    // us a mob to call lineSquareIntersection() on.
+    class RandomOccluders : public SimWorld
+    {
+    public:
+        virtual std::vector<int> getArgs() const
+        {
+            static const int s_Args[] = { 1, 4, 16 };
+            return std::vector<int>(s_Args, s_Args + (sizeof(s_Args) / sizeof(s_Args[0])));
+        }
+
+        virtual void setUp(int numBoxes)
+        {
+            SimWorld::setUp(10);
+
+            unsigned int seed = 54321;
+            m_Layouts.clear();
+            m_Layouts.resize(NUM_LAYOUTS);
+            m_Lines.clear();
+            for (unsigned int i = 0; i < NUM_LAYOUTS; ++i)
+            {
+                Layout& layout = m_Layouts[i];
+                for (int j = 0; j < numBoxes; ++j)
+                {
+                    Box box;
+                    box.m_Center = randomPoint(seed);
+                    box.m_Size = 0.5f + (randomFraction(seed) * 4.f);
+                    layout.m_Boxes.push_back(box);
+                    layout.m_Occluders.addBox(box.m_Center, box.m_Size);
+                }
+
+                for (unsigned int j = 0; j < NUM_LINES_PER_LAYOUT; ++j)
+                {
+                    Line line;
+                    line.m_Start = randomPoint(seed);
+                    line.m_End = randomPoint(seed);
+                    line.m_Layout = i;
+                    m_Lines.push_back(line);
+                }
+            }
+        }
+
+    protected:
+        static const unsigned int NUM_LAYOUTS = 256;
+        static const unsigned int NUM_LINES_PER_LAYOUT = 256;
+
+        // Segments closer than this to the edge of a box are grazing it, and 
+        // the tests are allowed to disagree about them.
+        static constexpr float GRAZING_MARGIN = 0.001f;
+
+        struct Box
+        {
+            Vec2 m_Center;
+            float m_Size;
+        };
+
+        struct Layout
+        {
+            std::vector<Box> m_Boxes;
+            Occluders m_Occluders;
+        };
+
+        struct Line
+        {
+            Vec2 m_Start;
+            Vec2 m_End;
+            unsigned int m_Layout;
+        };
+
+        // What lineSquareIntersection() makes of the line, with every box 
+        // grown by margin on each side (or shrunk, if it's negative).  A line 
+        // that starts inside a box doesn't cross its edges if it ends inside 
+        // it too, but it's blocked all the same.
+        bool isBlockedByEdgeTest(const Line& line, float margin) const
+        {
+            Mob& mob = *getMobs()[0];
+            for (const Box& box : m_Layouts[line.m_Layout].m_Boxes)
+            {
+                const float size = box.m_Size + (2.f * margin);
+                const float halfSize = size / 2.f;
+                if (((fabsf(line.m_Start.x - box.m_Center.x) <= halfSize) && (fabsf(line.m_Start.y - box.m_Center.y) <= halfSize)) ||
+                    BenchmarkAccess::lineSquareIntersection(mob, line.m_Start, line.m_End, size, box.m_Center))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        Vec2 randomPoint(unsigned int& seed) const
+        {
+            const float x = randomFraction(seed) * (float)GAME_GRID_WIDTH;
+            const float y = randomFraction(seed) * (float)GAME_GRID_HEIGHT;
+            return Vec2(x, y);
+        }
+
+    protected:
+        std::vector<Layout> m_Layouts;
+        std::vector<Line> m_Lines;
+    };
+}
+
+BENCHMARK_F(SimWorld, PickTarget)
+{
+    const std::vector<Mob*> mobs = getMobs();
+    while (state.keepRunning())
+    {
+        for (Mob* pMob : mobs)
+        {
+            BenchmarkAccess::pickTarget(*pMob);
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * mobs.size());
+}
+
+BENCHMARK_F(SimWorld, IsHiding)
+{
+    // Only Rogues get past the first line, so only time them.
+    std::vector<Mob*> rogues;
+    for (Mob* pMob : getMobs())
+    {
+        if (pMob->getStatsData().m_MobType == iEntityStats::Rogue)
+        {
+            rogues.push_back(pMob);
+        }
+    }
+
+    unsigned int numHiding = 0;
+    while (state.keepRunning())
+    {
+        for (const Mob* pMob : rogues)
+        {
+            numHiding += BenchmarkAccess::isHiding(*pMob) ? 1 : 0;
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * rogues.size());
+    doNotOptimize(numHiding);
+}
+
+BENCHMARK_F(SimWorld, Move)
+{
+    uint64_t numMoved = 0;
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        reset();
+        const std::vector<Mob*> mobs = getMobs();
+        state.resumeTiming();
+
+        for (Mob* pMob : mobs)
+        {
+            if (!pMob->isDead())
+            {
+                BenchmarkAccess::move(*pMob, TICK_MIN);
+                ++numMoved;
+            }
+        }
+    }
+    state.setItemsProcessed(numMoved);
+}
+
+BENCHMARK_F(SimWorld, LineSquareIntersection)
+{
+    // The line of sight test the Rogues do: from the enemy King to each mob,
+    // against each of the mob's own buildings.
+    const std::vector<Mob*> mobs = getMobs();
+
+    unsigned int numHits = 0;
+    uint64_t numTests = 0;
+    while (state.keepRunning())
+    {
+        for (const Mob* pMob : mobs)
+        {
+            const Player& friendlyPlayer = m_pGame->getPlayer(pMob->isNorth());
+            const Player& opposingPlayer = m_pGame->getPlayer(!pMob->isNorth());
+            const Vec2& start = opposingPlayer.getBuildings()[0]->getPosition();
+            for (const Entity* pBuilding : friendlyPlayer.getBuildings())
+            {
+                const bool bHit = BenchmarkAccess::lineSquareIntersection(
+                    *pMob, start, pBuilding->getStatsData().m_Size, pBuilding->getPosition());
+                numHits += bHit ? 1 : 0;
+                ++numTests;
+            }
+        }
+    }
+    state.setItemsProcessed(numTests);
+    doNotOptimize(numHits);
+}
+
+BENCHMARK_F(RandomOccluders, LineOfSightRandom)
+{
+    // The label says how often the SSE and scalar slab tests disagree with 
+    // lineSquareIntersection(), leaving out the lines that graze a box (the
+    // three do the sums differently, so they may round a touch either way).
+    unsigned int numGrazing = 0;
+    unsigned int numSSEDisagree = 0;
+    unsigned int numScalarDisagree = 0;
+    for (const Line& line : m_Lines)
+    {
+        const bool bEdgeTest = isBlockedByEdgeTest(line, GRAZING_MARGIN);
+        if (bEdgeTest != isBlockedByEdgeTest(line, -GRAZING_MARGIN))
+        {
+            ++numGrazing;
+            continue;
+        }
+
+        const Occluders& occluders = m_Layouts[line.m_Layout].m_Occluders;
+        numSSEDisagree += (occluders.isSegmentBlocked(line.m_Start, line.m_End) != bEdgeTest) ? 1 : 0;
+        numScalarDisagree += (occluders.isSegmentBlocked_Scalar(line.m_Start, line.m_End) != bEdgeTest) ? 1 : 0;
+    }
+
+    char label[128];
+    snprintf(label, sizeof(label), "%u SSE, %u scalar of %u disagree (%u grazing)",
+             numSSEDisagree, numScalarDisagree, (unsigned int)m_Lines.size() - numGrazing, numGrazing);
+    state.setLabel(label);
+    if ((numSSEDisagree > 0) || (numScalarDisagree > 0))
+    {
+        state.setError("the slab test disagrees with lineSquareIntersection");
+    }
+
+    unsigned int numBlocked = 0;
+    while (state.keepRunning())
+    {
+        for (const Line& line : m_Lines)
+        {
+            numBlocked += m_Layouts[line.m_Layout].m_Occluders.isSegmentBlocked(line.m_Start, line.m_End) ? 1 : 0;
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * m_Lines.size());
+    doNotOptimize(numBlocked);
+}
+
+BENCHMARK_F(SimWorld, LineOfSightExact)
+{
+    // The test the Rogues use, against all of the towers and Giants at once.
+    const std::vector<SightLine> lines = getSightLines();
+
+    unsigned int numBlocked = 0;
+    while (state.keepRunning())
+    {
+        for (const SightLine& line : lines)
+        {
+            numBlocked += line.m_pOccluders->isSegmentBlocked(line.m_Start, line.m_End) ? 1 : 0;
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * lines.size());
+    doNotOptimize(numBlocked);
+}
+
+BENCHMARK_F(SimWorld, LineOfSightTables)
+{
+    // The same lines as LineOfSightExact, with the towers looked up in the
+    // precomputed tables and only the Giants tested.  This is what the Rogues
+    // use, and it should always agree with the exact test.
+    const std::vector<SightLine> lines = getSightLines();
+
+    unsigned int numDisagree = 0;
+    for (const SightLine& line : lines)
+    {
+        const bool bExact = line.m_pOccluders->isSegmentBlocked(line.m_Start, line.m_End);
+        const bool bTables = line.m_pTowerVisibility->isSegmentBlocked(line.m_Start, line.m_End) ||
+                             line.m_pOccluders->isSegmentBlocked_Dynamic(line.m_Start, line.m_End);
+        numDisagree += (bExact != bTables) ? 1 : 0;
+    }
+
+    char label[128];
+    snprintf(label, sizeof(label), "%u of %u disagree", numDisagree, (unsigned int)lines.size());
+    state.setLabel(label);
+    if (numDisagree > 0)
+    {
+        state.setError("the tower visibility tables disagree with the exact test");
+    }
+
+    unsigned int numBlocked = 0;
+    while (state.keepRunning())
+    {
+        for (const SightLine& line : lines)
+        {
+            const bool bBlocked = line.m_pTowerVisibility->isSegmentBlocked(line.m_Start, line.m_End) ||
+                                  line.m_pOccluders->isSegmentBlocked_Dynamic(line.m_Start, line.m_End);
+            numBlocked += bBlocked ? 1 : 0;
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * lines.size());
+    doNotOptimize(numBlocked);
+}
+
+BENCHMARK_F(SimWorld, LineOfSightTiles)
+{
+    // The same lines as LineOfSightExact, walked through the tile grid (see
+    // LINE_OF_SIGHT_USE_TILES).  The label says how often the two disagree.
+    // The tiles may block lines that the exact test lets through, but they
+    // must never miss one that it blocks.
+    const std::vector<SightLine> lines = getSightLines();
+
+    unsigned int numExtra = 0;
+    unsigned int numMissed = 0;
+    for (const SightLine& line : lines)
+    {
+        const bool bExact = line.m_pOccluders->isSegmentBlocked(line.m_Start, line.m_End);
+        const bool bTiles = line.m_pOccluders->isSegmentBlocked_Tiles(line.m_Start, line.m_End);
+        numExtra += (bTiles && !bExact) ? 1 : 0;
+        numMissed += (bExact && !bTiles) ? 1 : 0;
+    }
+
+    char label[128];
+    snprintf(label, sizeof(label), "%.2f%% agree (%u extra blocked, %u missed, of %u)",
+             lines.empty() ? 100.0 : 100.0 * (double)(lines.size() - numExtra - numMissed) / (double)lines.size(),
+             numExtra, numMissed, (unsigned int)lines.size());
+    state.setLabel(label);
+    if (numMissed > 0)
+    {
+        state.setError("the tile walk misses lines that the exact test blocks");
+    }
+
+    unsigned int numBlocked = 0;
+    while (state.keepRunning())
+    {
+        for (const SightLine& line : lines)
+        {
+            numBlocked += line.m_pOccluders->isSegmentBlocked_Tiles(line.m_Start, line.m_End) ? 1 : 0;
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * lines.size());
+    doNotOptimize(numBlocked);
+}
+
+// The decide phase of a tick, for every entity of both players, on one 
+// thread.
+BENCHMARK_F(SimWorld, Decide)
+{
+    std::vector<Entity*> entities;
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        reset();
+        entities.clear();
+        m_pGame->getPlayer(true).getLiveEntities(entities);
+        m_pGame->getPlayer(false).getLiveEntities(entities);
+        state.resumeTiming();
+
+        for (Entity* pEntity : entities)
+        {
+            pEntity->decide(TICK_MIN);
+        }
+    }
+    state.setItemsProcessed(state.getIterations() * entities.size());
+}
+
+BENCHMARK_F(SimWorld, GameTick)
+{
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        reset();
+        state.resumeTiming();
+
+        m_pGame->tick(TICK_MIN);
+    }
+}
+
+// The same tick, with the decide phase spread over one thread per core.
+BENCHMARK_F(SimWorld, GameTickParallel)
+{
+    m_pGame->setNumThreads(0);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%u threads", m_pGame->getNumThreads());
+    state.setLabel(label);
+
+    while (state.keepRunning())
+    {
+        state.pauseTiming();
+        reset();
+        state.resumeTiming();
+
+        m_pGame->tick(TICK_MIN);
+    }
+}
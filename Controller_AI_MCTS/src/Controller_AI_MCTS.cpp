@@ -0,0 +1,480 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Controller_AI_MCTS.h"
+
+#include "Constants.h"
+#include "iPlayer.h"
+#include "iSandbox.h"
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+using std::chrono::steady_clock;
+
+// The spots we consider placing at, in player space: in front of each 
+// bridge, behind each princess tower, and in front of the king.
+static const Vec2 ksPlacements[] =
+{
+    Vec2(LEFT_BRIDGE_CENTER_X, RIVER_TOP_Y - 0.5f),
+    Vec2(RIGHT_BRIDGE_CENTER_X, RIVER_TOP_Y - 0.5f),
+    Vec2(PrincessLeftX, NorthPrincessY - 2.f),
+    Vec2(PrincessRightX, NorthPrincessY - 2.f),
+    Vec2(KingX, NorthKingY + 3.f),
+};
+static const unsigned int ksNumPlacements = sizeof(ksPlacements) / sizeof(ksPlacements[0]);
+
+// How much each tower counts for in evaluate().  The king (building 0) is 
+// the one that matters.
+static const float ksKingWeight = 2.f;
+static const float ksPrincessWeight = 1.f;
+
+static float towerScore(const iPlayer& player)
+{
+    float score = 0.f;
+    float total = 0.f;
+    for (unsigned int i = 0; i < player.getNumBuildings(); ++i)
+    {
+        const iPlayer::EntityData data = player.getBuilding(i);
+        const float weight = (i == 0) ? ksKingWeight : ksPrincessWeight;
+        score += weight * std::max(0.f, (float)data.m_Health / (float)data.m_Stats.getMaxHealth());
+        total += weight;
+    }
+
+    return (total > 0.f) ? (score / total) : 0.f;
+}
+
+bool Controller_AI_MCTS::Action::operator==(const Action& rhs) const
+{
+    if (m_bWait || rhs.m_bWait)
+    {
+        return m_bWait == rhs.m_bWait;
+    }
+
+    return (m_Type == rhs.m_Type) && (m_Pos.x == rhs.m_Pos.x) && (m_Pos.y == rhs.m_Pos.y);
+}
+
+Controller_AI_MCTS::Controller_AI_MCTS(float budgetSec, unsigned int numThreads)
+    : m_BudgetSec(budgetSec)
+    , m_NumThreads(numThreads)
+    , m_bNorth(false)
+    , m_ThinkSec(0.f)
+    , m_SearchId(0)
+    , m_NumSearching(0)
+    , m_bStop(false)
+{
+    if (m_NumThreads == 0)
+    {
+        m_NumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+}
+
+Controller_AI_MCTS::~Controller_AI_MCTS()
+{
+    stopWorkers();
+}
+
+void Controller_AI_MCTS::tick(float deltaTSec)
+{
+    assert(m_pPlayer);
+
+    // We can't make the sandboxes until we have a player.
+    if (m_Workers.empty())
+    {
+        startWorkers();
+    }
+
+    // If all we can do is wait, there's nothing to think about.
+    getLegalActions(m_LegalActions);
+    if (m_LegalActions.size() <= 1)
+    {
+        resetSearch();
+        return;
+    }
+
+    // If our options have changed (because we got more elixir, say), the 
+    // trees no longer line up with them, so start again.
+    if (m_LegalActions != m_Actions)
+    {
+        resetSearch();
+        m_Actions = m_LegalActions;
+    }
+
+    // The trees are open loop, so we can keep growing them from wherever the
+    // game is now.
+    m_pPlayer->takeSnapshot(m_Root);
+    m_ThinkSec += deltaTSec;
+    m_Deadline = steady_clock::now() + std::chrono::duration_cast<steady_clock::duration>(
+        std::chrono::duration<float>(m_BudgetSec));
+
+    // Worker 0 searches on this thread while the rest search on theirs.
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_NumSearching = (unsigned int)m_Workers.size() - 1;
+        ++m_SearchId;
+    }
+    m_WorkReady.notify_all();
+
+    search(*m_Workers[0], m_Deadline);
+
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_WorkDone.wait(lock, [this]() { return m_NumSearching == 0; });
+    }
+
+    // Pool the workers' root statistics.
+    m_RootVisits.assign(m_Actions.size(), 0);
+    unsigned int totalVisits = 0;
+    for (const Worker* pWorker : m_Workers)
+    {
+        const Node& root = pWorker->m_Nodes[0];
+        totalVisits += root.m_Visits;
+        if (root.m_FirstChild >= 0)
+        {
+            for (unsigned int i = 0; i < m_Actions.size(); ++i)
+            {
+                m_RootVisits[i] += pWorker->m_Nodes[root.m_FirstChild + i].m_Visits;
+            }
+        }
+    }
+
+    if ((totalVisits < MCTS_ITERATIONS_PER_DECISION) && (m_ThinkSec < MCTS_MAX_THINK_SEC))
+    {
+        return;
+    }
+
+    // Take the most visited action, which is less noisy than the best average.
+    const unsigned int best = (unsigned int)(std::max_element(m_RootVisits.begin(), m_RootVisits.end()) - m_RootVisits.begin());
+    const Action& action = m_Actions[best];
+    if (!action.m_bWait)
+    {
+        m_pPlayer->placeMob(action.m_Type, action.m_Pos.Player2Game(m_bNorth));
+    }
+
+    resetSearch();
+}
+
+void Controller_AI_MCTS::getLegalActions(std::vector<Action>& outActions) const
+{
+    outActions.clear();
+
+    Action wait;
+    wait.m_bWait = true;
+    wait.m_Type = iEntityStats::Swordsman;
+    outActions.push_back(wait);
+
+    const float elixir = m_pPlayer->getElixir();
+    for (iEntityStats::MobType type : m_pPlayer->GetAvailableMobTypes())
+    {
+        if (iEntityStats::getStats(type).getElixirCost() > elixir)
+        {
+            continue;
+        }
+
+        for (const Vec2& pos : ksPlacements)
+        {
+            if (isLegalPosition(pos.Player2Game(m_bNorth), m_bNorth))
+            {
+                Action place;
+                place.m_bWait = false;
+                place.m_Type = type;
+                place.m_Pos = pos;
+                outActions.push_back(place);
+            }
+        }
+    }
+}
+
+bool Controller_AI_MCTS::isLegalPosition(const Vec2& gamePos, bool bNorth)
+{
+    // NOTE: these are the checks that Player::placeMob() makes.
+    if (!isOnField(gamePos))
+    {
+        return false;
+    }
+
+    const float tileY = (float)toTileY(gamePos.y) + 0.5f;
+    return bNorth ? (tileY < RIVER_TOP_Y) : (tileY > RIVER_BOT_Y);
+}
+
+void Controller_AI_MCTS::startWorkers()
+{
+    assert(m_Workers.empty());
+    m_bNorth = m_pPlayer->isNorth();
+
+    // Make all of the workers before starting any threads, since the threads
+    // look themselves up in m_Workers.
+    for (unsigned int i = 0; i < m_NumThreads; ++i)
+    {
+        Worker* pWorker = new Worker;
+        pWorker->m_pSandbox = m_pPlayer->createSandbox();
+        pWorker->m_Rng.seed(1 + i);
+        m_Workers.push_back(pWorker);
+    }
+    resetSearch();
+
+    for (unsigned int i = 1; i < m_NumThreads; ++i)
+    {
+        m_Workers[i]->m_Thread = std::thread(&Controller_AI_MCTS::workerMain, this, i);
+    }
+}
+
+void Controller_AI_MCTS::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = true;
+    }
+    m_WorkReady.notify_all();
+
+    for (Worker* pWorker : m_Workers)
+    {
+        if (pWorker->m_Thread.joinable())
+        {
+            pWorker->m_Thread.join();
+        }
+        delete pWorker->m_pSandbox;
+        delete pWorker;
+    }
+    m_Workers.clear();
+}
+
+void Controller_AI_MCTS::workerMain(unsigned int workerIndex)
+{
+    Worker& worker = *m_Workers[workerIndex];
+
+    unsigned int searchId = 0;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point deadline;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [&]() { return m_bStop || (m_SearchId != searchId); });
+            if (m_bStop)
+            {
+                return;
+            }
+            searchId = m_SearchId;
+            deadline = m_Deadline;
+        }
+
+        search(worker, deadline);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            --m_NumSearching;
+        }
+        m_WorkDone.notify_one();
+    }
+}
+
+void Controller_AI_MCTS::search(Worker& worker, steady_clock::time_point deadline)
+{
+    while (steady_clock::now() < deadline)
+    {
+        if (!iterate(worker, deadline))
+        {
+            break;
+        }
+    }
+}
+
+bool Controller_AI_MCTS::iterate(Worker& worker, steady_clock::time_point deadline)
+{
+    iSandbox& sandbox = *worker.m_pSandbox;
+    std::vector<Node>& nodes = worker.m_Nodes;
+
+    sandbox.restore(m_Root);
+
+    // Selection and expansion: walk down the tree, playing our actions, 
+    // until we step into a node that has never been visited.
+    worker.m_Path.clear();
+    worker.m_Path.push_back(0);
+    int node = 0;
+    float elapsedSec = 0.f;
+    for (int depth = 0; (depth < MCTS_MAX_DEPTH) && (sandbox.checkGameOver() == 0); ++depth)
+    {
+        if (nodes[node].m_FirstChild < 0)
+        {
+            const int firstChild = (int)nodes.size();
+            Node child;
+            child.m_Visits = 0;
+            child.m_TotalValue = 0.f;
+            child.m_FirstChild = -1;
+            nodes.resize(nodes.size() + m_Actions.size(), child);
+            nodes[node].m_FirstChild = firstChild;
+        }
+
+        const int child = selectChild(worker, node);
+        apply(sandbox, m_bNorth, m_Actions[child - nodes[node].m_FirstChild]);
+        playRandomly(worker, !m_bNorth);
+        if (!simulate(sandbox, MCTS_STEP_SEC, deadline))
+        {
+            return false;
+        }
+        elapsedSec += MCTS_STEP_SEC;
+
+        node = child;
+        worker.m_Path.push_back(node);
+        if (nodes[node].m_Visits == 0)
+        {
+            break;
+        }
+    }
+
+    // Rollout: both sides play randomly out to the horizon.
+    while ((elapsedSec < MCTS_HORIZON_SEC) && (sandbox.checkGameOver() == 0))
+    {
+        playRandomly(worker, m_bNorth);
+        playRandomly(worker, !m_bNorth);
+        if (!simulate(sandbox, MCTS_STEP_SEC, deadline))
+        {
+            return false;
+        }
+        elapsedSec += MCTS_STEP_SEC;
+    }
+
+    // Backpropagation
+    const float value = evaluate(sandbox);
+    for (int i : worker.m_Path)
+    {
+        ++nodes[i].m_Visits;
+        nodes[i].m_TotalValue += value;
+    }
+
+    return true;
+}
+
+int Controller_AI_MCTS::selectChild(const Worker& worker, int node) const
+{
+    const std::vector<Node>& nodes = worker.m_Nodes;
+    const Node& parent = nodes[node];
+    assert(parent.m_FirstChild >= 0);
+
+    const float logParentVisits = logf((float)std::max(parent.m_Visits, 1u));
+
+    int best = parent.m_FirstChild;
+    float bestScore = -1.f;
+    for (int i = parent.m_FirstChild; i < parent.m_FirstChild + (int)m_Actions.size(); ++i)
+    {
+        const Node& child = nodes[i];
+
+        // Try everything once before trying anything twice.
+        if (child.m_Visits == 0)
+        {
+            return i;
+        }
+
+        const float score = (child.m_TotalValue / (float)child.m_Visits) + 
+                            MCTS_EXPLORATION * sqrtf(logParentVisits / (float)child.m_Visits);
+        if (score > bestScore)
+        {
+            best = i;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+void Controller_AI_MCTS::playRandomly(Worker& worker, bool bNorth) const
+{
+    // Pick a mob type (or nothing), and place it somewhere if we can afford it.
+    const iPlayer& player = worker.m_pSandbox->getPlayer(bNorth);
+    const std::vector<iEntityStats::MobType>& types = player.GetAvailableMobTypes();
+
+    const unsigned int choice = worker.m_Rng() % (unsigned int)(types.size() + 1);
+    if (choice == types.size())
+    {
+        return;
+    }
+
+    Action action;
+    action.m_bWait = false;
+    action.m_Type = types[choice];
+    if (iEntityStats::getStats(action.m_Type).getElixirCost() > player.getElixir())
+    {
+        return;
+    }
+
+    action.m_Pos = ksPlacements[worker.m_Rng() % ksNumPlacements];
+    apply(*worker.m_pSandbox, bNorth, action);
+}
+
+void Controller_AI_MCTS::apply(iSandbox& sandbox, bool bNorth, const Action& action) const
+{
+    // NOTE: deeper in the tree we may not be able to afford the action, in 
+    // which case placeMob() fails and it's the same as waiting.
+    if (!action.m_bWait)
+    {
+        sandbox.placeMob(bNorth, action.m_Type, action.m_Pos.Player2Game(bNorth));
+    }
+}
+
+bool Controller_AI_MCTS::simulate(iSandbox& sandbox, float durationSec, steady_clock::time_point deadline) const
+{
+    for (float t = 0.f; t < durationSec - 0.001f; t += MCTS_SIM_TICK_SEC)
+    {
+        if (steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+
+        sandbox.tick(MCTS_SIM_TICK_SEC);
+        if (sandbox.checkGameOver() != 0)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+float Controller_AI_MCTS::evaluate(iSandbox& sandbox) const
+{
+    const int gameOver = sandbox.checkGameOver();
+    if (gameOver != 0)
+    {
+        return ((gameOver > 0) == m_bNorth) ? 1.f : 0.f;
+    }
+
+    const float ours = towerScore(sandbox.getPlayer(m_bNorth));
+    const float theirs = towerScore(sandbox.getPlayer(!m_bNorth));
+    return 0.5f + (0.5f * (ours - theirs));
+}
+
+void Controller_AI_MCTS::resetSearch()
+{
+    Node root;
+    root.m_Visits = 0;
+    root.m_TotalValue = 0.f;
+    root.m_FirstChild = -1;
+
+    for (Worker* pWorker : m_Workers)
+    {
+        pWorker->m_Nodes.clear();
+        pWorker->m_Nodes.push_back(root);
+    }
+
+    m_Actions.clear();
+    m_ThinkSec = 0.f;
+}
@@ -0,0 +1,156 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "iController.h"
+
+#include "EntityStats.h"
+#include "GameSnapshot.h"
+#include "Vec2.h"
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+class iSandbox;
+
+// Search settings.  Times marked "game" are simulated time; the budget is 
+// real (wall clock) time.
+const float MCTS_DEFAULT_BUDGET_SEC = 0.005f;       // how long each tick() may search for
+const float MCTS_STEP_SEC = 1.f;                    // game time between decisions in the tree
+const int MCTS_MAX_DEPTH = 4;                       // decisions per line, before the rollout
+const float MCTS_HORIZON_SEC = 16.f;                // game time from the root to the evaluation
+const float MCTS_SIM_TICK_SEC = 0.2f;               // the sandbox dt (TICK_MAX - coarse, but fast)
+const unsigned int MCTS_ITERATIONS_PER_DECISION = 256;
+const float MCTS_MAX_THINK_SEC = 1.f;               // game time we'll deliberate before acting anyway
+const float MCTS_EXPLORATION = 1.4f;                // the UCT exploration constant
+
+// An AI that decides what to place, and where, with Monte Carlo tree search.
+//   Each decision considers waiting, or placing any available mob type that
+// we can afford at any of a handful of spots.  Every iteration restores the
+// current game into a sandbox, plays a line of those decisions (the opponent
+// plays randomly), then a random rollout out to MCTS_HORIZON_SEC, and scores
+// the result by the health of the towers.  The tree is "open loop" - its 
+// nodes are sequences of our actions, not game states - so it copes with the 
+// randomness of the opponent.
+//   The search is spread across a pool of workers, each with its own tree and
+// sandbox (root parallelization), and their root statistics are pooled to 
+// pick the move.  It's done in slices of at most the budget per tick(): the
+// trees carry over from tick to tick until we've done 
+// MCTS_ITERATIONS_PER_DECISION iterations (or thought for MCTS_MAX_THINK_SEC)
+// and act, so more cores means a decision that is both faster and better.
+class Controller_AI_MCTS : public iController
+{
+public:
+    // If numThreads is 0, we use one per core.
+    explicit Controller_AI_MCTS(float budgetSec = MCTS_DEFAULT_BUDGET_SEC, unsigned int numThreads = 0);
+    virtual ~Controller_AI_MCTS();
+
+    void tick(float deltaTSec);
+
+private:
+    // Placing a mob (at a position in player space, see Vec2::Player2Game()),
+    // or doing nothing if m_bWait is set.
+    struct Action
+    {
+        bool m_bWait;
+        iEntityStats::MobType m_Type;
+        Vec2 m_Pos;
+
+        bool operator==(const Action& rhs) const;
+    };
+
+    struct Node
+    {
+        unsigned int m_Visits;
+        float m_TotalValue;         // sum of the values of the iterations through here
+        int m_FirstChild;           // children are contiguous, one per action; -1 => unexpanded
+    };
+
+    struct Worker
+    {
+        iSandbox* m_pSandbox;
+        std::vector<Node> m_Nodes;  // m_Nodes[0] is the root
+        std::vector<int> m_Path;    // scratch, for backing up values
+        std::mt19937 m_Rng;
+        std::thread m_Thread;
+    };
+
+    // Fills outActions with the actions that are legal for us right now - 
+    // i.e. that Player::placeMob() would accept.  Waiting is always first.
+    void getLegalActions(std::vector<Action>& outActions) const;
+    static bool isLegalPosition(const Vec2& gamePos, bool bNorth);
+
+    void startWorkers();
+    void stopWorkers();
+    void workerMain(unsigned int workerIndex);
+
+    // Runs MCTS iterations on the worker's tree until the deadline.
+    void search(Worker& worker, std::chrono::steady_clock::time_point deadline);
+
+    // One iteration.  Returns false (without updating the tree) if it ran 
+    // out of time part way through.
+    bool iterate(Worker& worker, std::chrono::steady_clock::time_point deadline);
+
+    int selectChild(const Worker& worker, int node) const;
+
+    // Makes the random choices for either side, during tree steps (for the 
+    // opponent) and rollouts (for both).
+    void playRandomly(Worker& worker, bool bNorth) const;
+    void apply(iSandbox& sandbox, bool bNorth, const Action& action) const;
+
+    // Advances the sandbox by durationSec.  Returns false if the deadline 
+    // passed.
+    bool simulate(iSandbox& sandbox, float durationSec, std::chrono::steady_clock::time_point deadline) const;
+
+    // Scores the sandbox from our point of view, from 0 (lost) to 1 (won).
+    float evaluate(iSandbox& sandbox) const;
+
+    void resetSearch();
+
+private:
+    float m_BudgetSec;
+    unsigned int m_NumThreads;
+    bool m_bNorth;
+
+    std::vector<Worker*> m_Workers;     // m_Workers[0] runs on the game thread
+
+    // The current search.  Workers only read these while a search is running.
+    GameSnapshot m_Root;
+    std::vector<Action> m_Actions;
+    std::chrono::steady_clock::time_point m_Deadline;
+    float m_ThinkSec;
+
+    // Scratch space for tick(), kept around to avoid reallocating
+    std::vector<Action> m_LegalActions;
+    std::vector<unsigned int> m_RootVisits;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    unsigned int m_SearchId;            // bumped to start each slice of search
+    unsigned int m_NumSearching;        // workers (other than [0]) still busy
+    bool m_bStop;
+};
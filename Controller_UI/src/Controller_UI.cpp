@@ -38,44 +38,49 @@ Controller_UI::~Controller_UI()
 }
 
 void Controller_UI::tick(float deltaTSec) {
-    while(!events.empty()) {
-        SDL_Event e = events.front();
-        events.pop();
-
-        if ((e.type == SDL_MOUSEBUTTONUP) && (e.button.button == SDL_BUTTON_LEFT)) {
-            int pixelX = -1;
-            int pixelY = -1;
-            SDL_GetMouseState(&pixelX, &pixelY);
-            const Vec2 mousePos((float)(pixelX / PIXELS_PER_METER), (float)(pixelY / PIXELS_PER_METER));
-
-            iEntityStats::MobType mobType;
-            if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_A])
-            {
-                mobType = iEntityStats::Archer;
-            }
-            else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_S])
-            {
-                mobType = iEntityStats::Swordsman;
-            }
-            else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_G])
-            {
-                mobType = iEntityStats::Giant;
-            }
-            else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_R])
-            {
-                mobType = iEntityStats::Rogue;
-            }
-            else
-            {
-                continue;
-            }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_TickPlacements.swap(m_Placements);
+    }
 
-            assert(m_pPlayer);
-            m_pPlayer->placeMob(mobType, mousePos);
-        }
+    for (const Placement& placement : m_TickPlacements) {
+        assert(m_pPlayer);
+        m_pPlayer->placeMob(placement.m_Type, placement.m_Pos);
     }
+    m_TickPlacements.clear();
 }
 
 void Controller_UI::loadEvent(SDL_Event e) {
-    events.push(e);
-}
\ No newline at end of file
+    if ((e.type != SDL_MOUSEBUTTONUP) || (e.button.button != SDL_BUTTON_LEFT)) {
+        return;
+    }
+
+    Placement placement;
+    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_A])
+    {
+        placement.m_Type = iEntityStats::Archer;
+    }
+    else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_S])
+    {
+        placement.m_Type = iEntityStats::Swordsman;
+    }
+    else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_G])
+    {
+        placement.m_Type = iEntityStats::Giant;
+    }
+    else if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_R])
+    {
+        placement.m_Type = iEntityStats::Rogue;
+    }
+    else
+    {
+        return;
+    }
+
+    // The click's own position, rather than wherever the mouse is by the 
+    // time the simulation gets to it.
+    placement.m_Pos = Vec2((float)(e.button.x / PIXELS_PER_METER), (float)(e.button.y / PIXELS_PER_METER));
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Placements.push_back(placement);
+}
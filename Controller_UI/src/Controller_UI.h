@@ -23,9 +23,12 @@
 #pragma once
 
 #include "iController.h"
-#include <queue>
+#include "EntityStats.h"
+#include <mutex>
 #include "SDL.h"
 #include <Singleton.h>
+#include "Vec2.h"
+#include <vector>
 
 struct SDL_MouseButtonEvent;
 
@@ -53,10 +56,22 @@ public:
     virtual ~Controller_UI();
 
     void tick(float deltaTSec);
+
+    // NOTE: events come from the main thread, while tick() is called from 
+    // the simulation thread.  So we work out what each click asks for as it
+    // arrives (while the keyboard state still matches it), and queue that up
+    // for the next tick.
     void loadEvent(SDL_Event e);
 
 private:
-    
-    std::queue<SDL_Event> events;
+    struct Placement
+    {
+        iEntityStats::MobType m_Type;
+        Vec2 m_Pos;
+    };
+
+    std::mutex m_Mutex;                     // guards m_Placements
+    std::vector<Placement> m_Placements;    // clicks waiting for the next tick
+    std::vector<Placement> m_TickPlacements;    // scratch space for tick()
 
 };
\ No newline at end of file
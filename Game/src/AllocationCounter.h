@@ -0,0 +1,95 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Counts heap allocations, by replacing the global operator new, so that we 
+// can tell when something in the tick starts allocating again.  Game::tick() 
+// counts the allocations it makes (see Game::getLastTickAllocations()), and
+// logs them when there are any.
+//
+// The counter is compiled in for debug builds only, unless 
+// ALLOC_COUNTER_ENABLED is defined otherwise.  When it is compiled out, the 
+// count is always 0 and nothing is replaced.
+//
+// NOTE: the count is per thread, so each thread only sees its own 
+// allocations.  Game::tick() adds in those of its worker threads.
+
+#ifndef ALLOC_COUNTER_ENABLED
+#ifdef _DEBUG
+#define ALLOC_COUNTER_ENABLED 1
+#else
+#define ALLOC_COUNTER_ENABLED 0
+#endif
+#endif
+
+#include <stdint.h>
+
+class AllocationCounter
+{
+public:
+    static bool isEnabled() { return ALLOC_COUNTER_ENABLED != 0; }
+
+#if ALLOC_COUNTER_ENABLED
+
+    // How many times the calling thread has allocated from the heap, ever.
+    static uint64_t getCount() { return s_Count; }
+
+    // Allocations made on this thread in the rest of the block aren't counted
+    // - e.g. by the controllers, which aren't part of the simulation.  These 
+    // nest.
+    class ScopedIgnore
+    {
+    public:
+        ScopedIgnore() { ++s_IgnoreDepth; }
+        ~ScopedIgnore() { --s_IgnoreDepth; }
+    };
+
+    // Called by operator new.
+    static void onAllocate()
+    {
+        if (s_IgnoreDepth == 0)
+        {
+            ++s_Count;
+        }
+    }
+
+private:
+    static thread_local uint64_t s_Count;
+    static thread_local int s_IgnoreDepth;
+
+#else
+
+    static uint64_t getCount() { return 0; }
+
+    // NOTE: the constructor and destructor are user-provided (if empty), as
+    // in the real one, so that the compiler doesn't warn that the 
+    // ScopedIgnores are unused.
+    class ScopedIgnore
+    {
+    public:
+        ScopedIgnore() {}
+        ~ScopedIgnore() {}
+    };
+
+#endif
+};
@@ -22,8 +22,9 @@
 
 #include "Building.h"
 
-Building::Building(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-    : Entity(stats, pos, isNorth)
+Building::Building(Game& game, EntityStore& store, const iEntityStats& stats, const Vec2& pos, bool isNorth)
+    // Buildings are never freed, so their handle is just their slot.
+    : Entity(game, store, EntityHandle(isNorth, true, store.size(), 0), stats, pos, isNorth)
 {
     assert(dynamic_cast<const iEntityStats_Building*>(&stats) != NULL);
 }
@@ -27,6 +27,6 @@
 class Building : public Entity 
 {
 public:
-    Building(const iEntityStats& stats, const Vec2& pos, bool isNorth);
+    Building(Game& game, EntityStore& store, const iEntityStats& stats, const Vec2& pos, bool isNorth);
 };
 
@@ -20,14 +20,39 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "AllocationCounter.h"
 #include "Building.h"
 #include "Constants.h"
+#include "Controller_AI_KevinDill.h"
+#include "Controller_AI_MCTS.h"
 #include "Controller_UI.h"
 #include "Game.h"
 #include "Graphics.h"
+#include "Log.h"
+#include "MatchRunner.h"
 #include "Player.h"
+#include "Profiler.h"
+#include "RenderFrame.h"
+#include "Replay.h"
+#include "StateHash.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+// Headless mode: "CrashLoyal -headless [numMatches] [maxTicksPerMatch] [numThreads] [-mcts] [-record prefix] [-profile path]"
+//            or: "CrashLoyal -headless -replay path [-hashes outPath] [-verify hashesPath] [-profile path]"
+//            or: "CrashLoyal -headless -diffhashes hashesPathA hashesPathB"
+const int HEADLESS_DEFAULT_MATCHES = 1;
+const int HEADLESS_DEFAULT_MAX_TICKS = 12000; // 10 minutes of game time at TICK_MIN
+const int HEADLESS_DEFAULT_THREADS = 0; // one per core
+
+// Windowed games are always recorded, here unless -record says otherwise.
+const char* const DEFAULT_REPLAY_PATH = "last_match.replay";
 
 bool init() {
     return true;
@@ -41,85 +66,540 @@ void close() {
     SDL_Quit();
 }
 
+// -profile: records the profiler (see Profiler.h) from here on.  Returns false
+// if it isn't compiled in.
+bool startProfiling()
+{
+#if PROFILER_ENABLED
+    Profiler::get().start();
+    return true;
+#else
+    printf("Profiling isn't compiled in - build with PROFILER_ENABLED=1 to use -profile.\n");
+    return false;
+#endif
+}
+
+// Saves what startProfiling() recorded as a Chrome trace, and shuts the 
+// profiler down.
+void saveProfile(const std::string& path)
+{
+#if PROFILER_ENABLED
+    Profiler::get().stop();
+    if (Profiler::get().save(path))
+    {
+        printf("Saved profile to %s\n", path.c_str());
+    }
+    else
+    {
+        printf("Couldn't write profile %s\n", path.c_str());
+    }
+    Profiler::shutdown();
+#else
+    (void)path;
+#endif
+}
+
+// Plays AI-vs-AI matches with no window, ticking the game at a fixed simulated
+// dt as fast as the CPU allows.  Each match runs until somebody wins or it hits
+// maxTicks, and then we report how fast the simulation ran.  The matches are
+// spread over numThreads threads (0 means one per core).  If bMCTS is set,
+// South is played by Controller_AI_MCTS rather than Kevin's AI.  If 
+// replayPrefix isn't empty, each match is recorded (see MatchRunner).
+int runHeadless(int numMatches, int maxTicks, int numThreads, bool bMCTS, const std::string& replayPrefix)
+{
+    using namespace std::chrono;
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+
+    MatchRunner runner((unsigned int)numThreads);
+    runner.setReplayPrefix(replayPrefix);
+
+    // If the matches are already running in parallel, each search gets just
+    // one thread.  Otherwise it gets one per core.
+    const bool bParallelMatches = (std::min(runner.getNumThreads(), (unsigned int)numMatches) > 1);
+    const unsigned int searchThreads = bParallelMatches ? 1 : 0;
+
+    std::vector<MatchResult> results = runner.run((unsigned int)numMatches, maxTicks, TICK_MIN,
+        [=](bool bNorth) -> iController* 
+        {
+            if (bMCTS && !bNorth)
+            {
+                return new Controller_AI_MCTS(MCTS_DEFAULT_BUDGET_SEC, searchThreads);
+            }
+            return new Controller_AI_KevinDill;
+        });
+
+    double elapsedSec = duration<double>(high_resolution_clock::now() - startTime).count();
+    elapsedSec = std::max(elapsedSec, 0.000001);
+
+    // Keep the matches' log messages ahead of the results.
+    Log::get().flush();
+
+    long long totalTicks = 0;
+    long long totalAllocations = 0;
+    int northWins = 0;
+    int southWins = 0;
+    int draws = 0;
+
+    for (int match = 0; match < numMatches; ++match)
+    {
+        const MatchResult& result = results[match];
+
+        totalTicks += result.m_NumTicks;
+        totalAllocations += result.m_NumAllocations;
+        if (result.m_Winner > 0) ++northWins;
+        else if (result.m_Winner < 0) ++southWins;
+        else ++draws;
+
+        printf("Match %d: %s after %d ticks\n", match + 1,
+            (result.m_Winner > 0) ? "North wins" : ((result.m_Winner < 0) ? "South wins" : "No winner"), 
+            result.m_NumTicks);
+    }
+
+    printf("Played %d matches (North %d, South %d, no winner %d) on %u threads in %.3f sec\n",
+        numMatches, northWins, southWins, draws, runner.getNumThreads(), elapsedSec);
+    printf("%.2f matches/sec, %.0f ticks/sec\n",
+        (double)numMatches / elapsedSec, (double)totalTicks / elapsedSec);
+    if (AllocationCounter::isEnabled())
+    {
+        printf("%lld heap allocations in the ticks (%.2f per tick)\n", totalAllocations,
+            (double)totalAllocations / (double)std::max(totalTicks, 1LL));
+    }
+
+    return 0;
+}
+
+// Prints the first tick where two runs' states differ, if they do.
+static void printDivergence(const StateHashLog& expected, const StateHashLog& actual, int tick)
+{
+    if (tick < 0)
+    {
+        printf("All %u ticks match\n", expected.getNumTicks());
+    }
+    else if (((unsigned int)tick < expected.getNumTicks()) && ((unsigned int)tick < actual.getNumTicks()))
+    {
+        printf("Diverged at tick %d: expected %016llx, got %016llx\n", tick,
+            (unsigned long long)expected.getHash(tick), (unsigned long long)actual.getHash(tick));
+    }
+    else
+    {
+        printf("Matched for %d ticks, but one run has %u ticks and the other %u\n", tick,
+            expected.getNumTicks(), actual.getNumTicks());
+    }
+}
+
+// Re-simulates a replay with no window, as fast as possible, and reports how
+// it came out.  The state hash of every tick can be saved to hashOutPath,
+// and/or checked against those in verifyPath (from an earlier run), in which
+// case we stop at the first tick that differs.
+int runReplayHeadless(const std::string& path, const std::string& hashOutPath, const std::string& verifyPath)
+{
+    ReplayReader replay;
+    if (!replay.load(path))
+    {
+        return 1;
+    }
+
+    StateHashLog expected;
+    const bool bVerify = !verifyPath.empty();
+    if (bVerify && !expected.load(verifyPath))
+    {
+        return 1;
+    }
+
+    using namespace std::chrono;
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+
+    StateHashLog hashes;
+    int divergedTick = -1;
+    Game game(new ReplayController(replay, true), new ReplayController(replay, false));
+    while (!replay.isFinished())
+    {
+        game.tick(replay.getDeltaT());
+        replay.advance();
+
+        hashes.add(game.getStateHash());
+        const unsigned int tick = hashes.getNumTicks() - 1;
+        if (bVerify && (tick < expected.getNumTicks()) && (expected.getHash(tick) != hashes.getHash(tick)))
+        {
+            divergedTick = (int)tick;
+            break;
+        }
+    }
+
+    double elapsedSec = duration<double>(high_resolution_clock::now() - startTime).count();
+    elapsedSec = std::max(elapsedSec, 0.000001);
+
+    Log::get().flush();
+
+    const int winner = game.checkGameOver();
+    printf("Replayed %u ticks: %s\n", hashes.getNumTicks(),
+        (winner > 0) ? "North wins" : ((winner < 0) ? "South wins" : "No winner"));
+    printf("%.3f sec, %.0f ticks/sec\n", elapsedSec, (double)hashes.getNumTicks() / elapsedSec);
+
+    if (!hashOutPath.empty() && !hashes.save(hashOutPath))
+    {
+        printf("Couldn't write hash log %s\n", hashOutPath.c_str());
+    }
+
+    if (bVerify)
+    {
+        if ((divergedTick < 0) && (hashes.getNumTicks() != expected.getNumTicks()))
+        {
+            divergedTick = (int)std::min(hashes.getNumTicks(), expected.getNumTicks());
+        }
+        printDivergence(expected, hashes, divergedTick);
+        return (divergedTick < 0) ? 0 : 1;
+    }
+
+    return 0;
+}
+
+// Compares the state hashes from two runs of the same match.
+int runDiffHashes(const std::string& pathA, const std::string& pathB)
+{
+    StateHashLog a;
+    StateHashLog b;
+    if (!a.load(pathA) || !b.load(pathB))
+    {
+        return 1;
+    }
+
+    const int tick = StateHashLog::findDivergence(a, b);
+    printDivergence(a, b, tick);
+    return (tick < 0) ? 0 : 1;
+}
+
 int main(int argc, char* args[]) {
-    Game& game = Game::get();
+    // Make sure the log exists before any threads start using it, since 
+    // Singleton::get() isn't thread safe.
+    Log::get();
+
+    if ((argc > 1) && (strcmp(args[1], "-headless") == 0))
+    {
+        // The numbers are positional, and the options can go anywhere among them.
+        int numbers[] = { HEADLESS_DEFAULT_MATCHES, HEADLESS_DEFAULT_MAX_TICKS, HEADLESS_DEFAULT_THREADS };
+        int numNumbers = 0;
+        bool bMCTS = false;
+        std::string replayPrefix;
+        std::string replayPath;
+        std::string hashOutPath;
+        std::string verifyPath;
+        std::string diffPaths[2];
+        std::string profilePath;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (strcmp(args[i], "-mcts") == 0)
+            {
+                bMCTS = true;
+            }
+            else if ((strcmp(args[i], "-record") == 0) && (i + 1 < argc))
+            {
+                replayPrefix = args[++i];
+            }
+            else if ((strcmp(args[i], "-replay") == 0) && (i + 1 < argc))
+            {
+                replayPath = args[++i];
+            }
+            else if ((strcmp(args[i], "-hashes") == 0) && (i + 1 < argc))
+            {
+                hashOutPath = args[++i];
+            }
+            else if ((strcmp(args[i], "-verify") == 0) && (i + 1 < argc))
+            {
+                verifyPath = args[++i];
+            }
+            else if ((strcmp(args[i], "-diffhashes") == 0) && (i + 2 < argc))
+            {
+                diffPaths[0] = args[++i];
+                diffPaths[1] = args[++i];
+            }
+            else if ((strcmp(args[i], "-profile") == 0) && (i + 1 < argc))
+            {
+                profilePath = args[++i];
+            }
+            else if (numNumbers < 3)
+            {
+                numbers[numNumbers++] = atoi(args[i]);
+            }
+        }
+
+        if (!profilePath.empty() && !startProfiling())
+        {
+            profilePath.clear();
+        }
+
+        int result = !diffPaths[0].empty() ? runDiffHashes(diffPaths[0], diffPaths[1]) :
+            !replayPath.empty() ? runReplayHeadless(replayPath, hashOutPath, verifyPath) :
+            runHeadless(std::max(numbers[0], 1), std::max(numbers[1], 1), std::max(numbers[2], 0), bMCTS, replayPrefix);
+        if (!profilePath.empty())
+        {
+            saveProfile(profilePath);
+        }
+        Log::shutdown();
+        return result;
+    }
+
+    // Windowed mode: "CrashLoyal [-tickrate ticksPerSec] [-tickthreads numThreads] [-vsync] [-record path] [-profile path]"
+    //            or: "CrashLoyal -replay path [-speed multiplier] [-tickthreads numThreads] [-vsync] [-profile path]"
+    // -tickthreads: how many threads each tick's decide phase runs on (see 
+    // Game::setNumThreads()); 0 means one per core.
+    float tickRate = DEFAULT_TICK_RATE;
+    unsigned int tickThreads = 1;
+    bool bVSync = false;
+    std::string recordPath = DEFAULT_REPLAY_PATH;
+    std::string replayPath;
+    float replaySpeed = 1.f;
+    std::string profilePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(args[i], "-tickrate") == 0) && (i + 1 < argc))
+        {
+            tickRate = (float)atof(args[++i]);
+        }
+        else if ((strcmp(args[i], "-tickthreads") == 0) && (i + 1 < argc))
+        {
+            tickThreads = (unsigned int)std::max(atoi(args[++i]), 0);
+        }
+        else if (strcmp(args[i], "-vsync") == 0)
+        {
+            bVSync = true;
+        }
+        else if ((strcmp(args[i], "-record") == 0) && (i + 1 < argc))
+        {
+            recordPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-replay") == 0) && (i + 1 < argc))
+        {
+            replayPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-speed") == 0) && (i + 1 < argc))
+        {
+            replaySpeed = std::max((float)atof(args[++i]), 0.01f);
+        }
+        else if ((strcmp(args[i], "-profile") == 0) && (i + 1 < argc))
+        {
+            profilePath = args[++i];
+        }
+    }
+
+    if (!profilePath.empty() && !startProfiling())
+    {
+        profilePath.clear();
+    }
+
+    // A replay plays at its recorded dts (scaled by replaySpeed), and isn't 
+    // itself recorded.
+    ReplayReader replay;
+    ReplayReader* pReplay = NULL;
+    if (!replayPath.empty())
+    {
+        if (!replay.load(replayPath))
+        {
+            Log::shutdown();
+            return 1;
+        }
+        pReplay = &replay;
+    }
+
+    // Every tick simulates the same amount of time, which must be no more than TICK_MAX.
+    tickRate = std::max(tickRate, 1.f / TICK_MAX);
+    const double tickSec = 1.0 / tickRate;
+
+    // NOTE: this has to be set before the renderer is created.
+    if (bVSync)
+    {
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+    }
+
+    // NOTE: the default Game picks the controllers (see Game::Game()).
+    Game* pGame = pReplay ? new Game(new ReplayController(replay, true), new ReplayController(replay, false)) : new Game;
+    Game& game = *pGame;
+    game.setNumThreads(tickThreads);
+
+    ReplayRecorder recorder;
+    if (!pReplay)
+    {
+        game.setRecorder(&recorder);
+    }
+
+    // How much real time the next tick takes up.
+    auto nextTickRealSec = [&]() -> double
+    {
+        return (pReplay && !pReplay->isFinished()) ? (pReplay->getDeltaT() / replaySpeed) : tickSec;
+    };
+
     Graphics& graphics = Graphics::get();
 
+    // The simulation runs on a thread of its own, publishing a RenderFrame 
+    // after every tick, and this (the main) thread polls events and draws the
+    // latest frame.  So a slow present never holds up a tick, and the ticks 
+    // never hold up the window.  Start with a frame of the initial state, so
+    // there's something to draw.
+    RenderFrameBuffer frames;
+    frames.getWriteFrame().capture(game);
+    frames.publish();
+
+    std::atomic<bool> bQuit(false);
+
     //Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
     }
     else {
-        using namespace std::chrono;
-        high_resolution_clock::time_point prevTime = high_resolution_clock::now();
+        // We may not get vsync even if we ask for it, in which case we wait 
+        // for new frames instead.
+        bVSync = graphics.isVSynced();
 
-        bool quit = false;
-        SDL_Event e;
-        while (!quit) {
-            // Get the elapsed time, and ensure it's at between TICK_MIN and TICK_MAX
-            high_resolution_clock::time_point now = high_resolution_clock::now();
-            double deltaTSec = (float)duration_cast<milliseconds>(now - prevTime).count() / 1000;
+        std::thread simThread([&]()
+        {
+            using namespace std::chrono;
+            steady_clock::time_point prevTime = steady_clock::now();
 
-            if (deltaTSec > TICK_MAX)
+            // Real time that has passed but hasn't been simulated yet.  
+            // Leftover time carries over to the next pass, rather than being
+            // dropped.
+            double accumulatorSec = 0.0;
+
+            while (!bQuit)
             {
-                std::cout << "Tick duration over budget: " << deltaTSec << std::endl;
-                deltaTSec = TICK_MAX;
-            }
+                steady_clock::time_point now = steady_clock::now();
+                accumulatorSec += duration<double>(now - prevTime).count();
+                prevTime = now;
 
-            if (deltaTSec < TICK_MIN)
-                continue;
+                // If we've fallen a long way behind (e.g. a tick took 
+                // forever), give up on catching up rather than running a 
+                // burst of ticks.
+                if (accumulatorSec > MAX_TICK_BACKLOG)
+                {
+                    LOG(System, Warning, "Simulation is %g sec behind, skipping ahead\n", accumulatorSec - nextTickRealSec());
+                    PROFILE_INSTANT("Simulation behind");
+                    accumulatorSec = nextTickRealSec();
+                }
+
+                // TICK 
+                {
+                    PROFILE_SCOPE("Simulate");
+                    while (!bQuit && (accumulatorSec >= nextTickRealSec()))
+                    {
+                        accumulatorSec -= nextTickRealSec();
+                        if (pReplay)
+                        {
+                            // Once the replay is over, the game just sits there.
+                            if (pReplay->isFinished())
+                            {
+                                continue;
+                            }
+                            game.tick(pReplay->getDeltaT());
+                            pReplay->advance();
+                        }
+                        else
+                        {
+                            game.tick((float)tickSec);
+                        }
+
+                        PROFILE_SCOPE("Publish frame");
+                        frames.getWriteFrame().capture(game);
+                        frames.publish();
+                    }
+                }
 
-            prevTime = now;
+                // Sleep until the next tick is due.
+                const double sleepSec = nextTickRealSec() - accumulatorSec - duration<double>(steady_clock::now() - prevTime).count();
+                if (sleepSec > 0.0)
+                {
+                    PROFILE_SCOPE("Sleep");
+                    std::this_thread::sleep_for(duration<double>(sleepSec));
+                }
+            }
+        });
 
-            graphics.resetFrame();
+        SDL_Event e;
+        while (!bQuit) {
+            PROFILE_SCOPE("Frame");
 
             // Handle UI events - quit if appropriate, otherwise, pass them on to the UI controller (if any)
-            while (SDL_PollEvent(&e) != 0) {
-                if (e.type == SDL_QUIT) { quit = true; }
-                if (Controller_UI::exists()) {
-                    Controller_UI::get().loadEvent(e);
+            {
+                PROFILE_SCOPE("Poll events");
+                while (SDL_PollEvent(&e) != 0) {
+                    if (e.type == SDL_QUIT) { bQuit = true; }
+                    graphics.handleEvent(e);
+                    if (Controller_UI::exists()) {
+                        Controller_UI::get().loadEvent(e);
+                    }
                 }
             }
 
-            // TICK 
-            game.tick((float)deltaTSec);
+            // With vsync, presenting the frame is what paces the loop, so we 
+            // draw every time around.  Otherwise we wait for the simulation 
+            // to publish a new frame (but not for long, so that we keep 
+            // handling events), and only draw when we get one.
+            bool bNewFrame = false;
+            {
+                PROFILE_SCOPE("Wait for frame");
+                bNewFrame = frames.acquire(bVSync ? 0.0 : MAX_FRAME_WAIT);
+            }
 
             // RENDER
-            Player& northPlayer = game.getPlayer(true);
-            Player& southPlayer = game.getPlayer(false);
+            if (bVSync || bNewFrame)
+            {
+                PROFILE_SCOPE("Render");
+                const RenderFrame& frame = frames.getReadFrame();
 
-            for (Entity* pBuilding : northPlayer.getBuildings()) {
-                graphics.drawBuilding(pBuilding);
-            }
+                {
+                    PROFILE_SCOPE("Reset frame");
+                    graphics.resetFrame();
+                }
 
-            for (Entity* pBuilding : southPlayer.getBuildings()) {
-                graphics.drawBuilding(pBuilding);
-            }
+                {
+                    PROFILE_SCOPE("Draw buildings");
+                    for (const RenderEntity& building : frame.m_Buildings) {
+                        graphics.drawBuilding(building);
+                    }
+                }
 
-            for (Entity* m : northPlayer.getMobs()) {
-                if (!m->isDead()) {
-                    graphics.drawMob(m);
+                {
+                    PROFILE_SCOPE("Draw mobs");
+                    graphics.drawMobs(frame.m_Mobs);
                 }
-            }
 
-            for (Entity* m : southPlayer.getMobs()) {
-                if (!m->isDead()) {
-                    graphics.drawMob(m);
+                {
+                    PROFILE_SCOPE("Draw UI");
+
+                    // Draw the elixir values:
+                    graphics.drawElixir(frame.m_NorthElixir, frame.m_SouthElixir);
+
+                    // If there is a winner, draw the message to the screen
+                    graphics.drawWinScreen(frame.m_Winner);
                 }
-            }
 
-            // Draw the elixir values:
-            graphics.drawElixir(northPlayer.getElixir(), southPlayer.getElixir());
+                PROFILE_SCOPE("Present");
+                graphics.render();
+            }
+        }
 
-            // If there is a winner, draw the message to the screen
-            graphics.drawWinScreen(game.checkGameOver());
+        simThread.join();
+    }
 
-            graphics.render();
+    if (!pReplay)
+    {
+        if (recorder.save(recordPath))
+        {
+            printf("Saved replay of %u ticks to %s\n", recorder.getNumTicks(), recordPath.c_str());
         }
+        else
+        {
+            printf("Couldn't write replay %s\n", recordPath.c_str());
+        }
+    }
+    delete pGame;
 
+    if (!profilePath.empty())
+    {
+        saveProfile(profilePath);
     }
 
     close();
+    Log::shutdown();
     return 0;
 }
 
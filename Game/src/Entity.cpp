@@ -24,84 +24,109 @@
 
 #include "Building.h"
 #include "Game.h"
+#include "Log.h"
 #include "Mob.h"
 #include "Player.h"
+#include "StateHash.h"
 
-Entity::Entity(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-    : m_Stats(stats)
+Entity::Entity(Game& game, EntityStore& store, const EntityHandle& handle, const iEntityStats& stats, const Vec2& pos, bool isNorth)
+    : m_Game(game)
+    , m_Stats(stats)
+    , m_Data(lookupStatsData(stats))
     , m_bNorth(isNorth)
-    , m_Health(stats.getMaxHealth())
-    , m_Pos(pos)
-    , m_pTarget(NULL)
-    , m_bTargetLock(NULL)
-    , m_TimeSinceAttack(0.f)
+    , m_bTargetLock(false)
+    , m_Handle(handle)
+    , m_pStore(&store)
+    , m_Index(store.add(this, stats, pos))
 {
-    static int s_NextID = 0;
-    id = s_NextID++;
+    id = m_Game.nextEntityId();
 }
 
-void Entity::tick(float deltaTSec)
+void Entity::decide(float deltaTSec)
 {
     // Project 2: You may need to do something special here to change the way the Rogue
     // does damage, or how much damage it does (among other things).
 
+    // Unless we decide otherwise, we stay put and don't attack.
+    nextPos() = pos();
+    m_pStore->m_AttackTarget[m_Index] = EntityHandle();
+    m_pStore->m_AttackDamage[m_Index] = 0;
+
     pickTarget();
-    m_TimeSinceAttack += deltaTSec;
+    timeSinceAttack() += deltaTSec;
     int damage;
 
    
-    if (targetInRange() && (m_TimeSinceAttack > m_Stats.getAttackTime()))
+    if (targetInRange() && (timeSinceAttack() > m_Data.m_AttackTime))
     {
         // If the Enitity is Spring Attacking, do the Spring Attack damage.
         if (isInSpringAttackRange)
         {
 
-            damage = m_Stats.getSpringAttackDamage();
-            printf("doing Spring attack damage %d. Damage: %d \n", isInSpringAttackRange, damage);
+            damage = m_Data.m_SpringAttackDamage;
+            LOG(Combat, Debug, "doing Spring attack damage %d. Damage: %d \n", isInSpringAttackRange, damage);
         }
         else
         {
-            damage = m_Stats.getDamage();
+            damage = m_Data.m_Damage;
         }
 
-        char buff[200];
-        snprintf(buff, 200, "%s %s attacks %s %s for %d damage.\n",
-                 m_bNorth ? "North" : "South",
-                 m_Stats.getName(),
-                 m_pTarget->isNorth() ? "North" : "South",
-                 m_pTarget->getStats().getName(),
-                 damage);
-        std::cout << buff;
-
         m_bTargetLock = true;
         
-        m_pTarget->takeDamage(damage);
-        m_TimeSinceAttack = 0.f;
+        // The damage is dealt in apply(), so that the target still has its
+        // health for the rest of the decide phase.
+        m_pStore->m_AttackTarget[m_Index] = target()->getHandle();
+        m_pStore->m_AttackDamage[m_Index] = damage;
+        timeSinceAttack() = 0.f;
+    }
+}
+
+void Entity::apply()
+{
+    pos() = nextPos();
+
+    const int damage = m_pStore->m_AttackDamage[m_Index];
+    if (damage > 0)
+    {
+        // NOTE: the target can't have been freed yet - dead mobs are only 
+        // freed once every entity has applied its tick.
+        Entity* pTarget = m_Game.getEntity(m_pStore->m_AttackTarget[m_Index]);
+        assert(pTarget);
+
+        LOG(Combat, Info, "%s %s attacks %s %s for %d damage.\n",
+            m_bNorth ? "North" : "South",
+            m_Data.m_Name,
+            pTarget->isNorth() ? "North" : "South",
+            pTarget->getStatsData().m_Name,
+            damage);
+
+        pTarget->takeDamage(damage);
     }
 }
 
 void Entity::pickTarget()
 {
-    assert(!m_bTargetLock || !!m_pTarget);
-    if (m_bTargetLock && !m_pTarget->isDead())
+    // NOTE: if our target has been freed (which happens at the end of its
+    // owner's tick, once it's dead) then the handle no longer resolves.
+    Entity* pTarget = target();
+    if (m_bTargetLock && !!pTarget && !pTarget->isDead())
     {
         return;
     }
 
-    m_pTarget = NULL;
+    setTarget(NULL);
     m_bTargetLock = false;
 
-    Game& game = Game::get();
 
     // we only attack things that are within our sight radius
-    float closestDist = getStats().getSightRadius();
+    float closestDist = m_Data.m_SightRadius;
     float closestDistSq = closestDist * closestDist;
 
-    Player& opposingPlayer = Game::get().getPlayer(!m_bNorth);
+    Player& opposingPlayer = m_Game.getPlayer(!m_bNorth);
 
 
 
-    if (m_Stats.getTargetType() != iEntityStats::Mob)
+    if (m_Data.m_TargetType != iEntityStats::Mob)
     {
         for (Entity* pEntity : opposingPlayer.getBuildings())
         {
@@ -109,32 +134,53 @@ void Entity::pickTarget()
             // Cannot choose targets that are hiding.
             if (!pEntity->isDead() && !pEntity->isHidden())
             {
-                float distSq = m_Pos.distSqr(pEntity->getPosition());
+                float distSq = pos().distSqr(pEntity->getPosition());
                 if (distSq < closestDistSq)
                 {
                     closestDistSq = distSq;
-                    m_pTarget = pEntity;
+                    setTarget(pEntity);
                 }
             }
         }
     }
 
-    if (m_Stats.getTargetType() != iEntityStats::Building)
+    if (m_Data.m_TargetType != iEntityStats::Building)
     {
-        for (Entity* pEntity : opposingPlayer.getMobs())
-        {
-            assert(pEntity->isNorth() != isNorth());
+        // Only visit the grid cells within our sight radius, and read the 
+        // opposing mobs straight out of their store.
+        const SpatialGrid& opposingGrid = m_Game.getMobGrid(!m_bNorth);
+        const EntityStore& opposingMobs = opposingPlayer.getMobStore();
+        const std::vector<Vec2>& positions = opposingMobs.getPositions();
+        const std::vector<int>& healths = opposingMobs.getHealths();
+        const std::vector<unsigned char>& hidden = opposingMobs.getHidden();
+        const Vec2& myPos = pos();
 
-            // Cannot choose targets that are hiding.
-            if (!pEntity->isDead() && !pEntity->isHidden())
+        int minX, minY, maxX, maxY;
+        opposingGrid.getCellRange(myPos, closestDist, minX, minY, maxX, maxY);
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
             {
-                float distSq = m_Pos.distSqr(pEntity->getPosition());
-                if (distSq < closestDistSq)
+                // Skip cells that can't hold anything closer than what we have.
+                if (opposingGrid.cellDistSqr(x, y, myPos) >= closestDistSq)
                 {
-                    closestDistSq = distSq;
-                    m_pTarget = pEntity;
+                    continue;
+                }
+
+                for (unsigned int i : opposingGrid.getCell(x, y))
+                {
+                    // Cannot choose targets that are hiding.
+                    if ((healths[i] > 0) && !hidden[i])
+                    {
+                        float distSq = myPos.distSqr(positions[i]);
+                        if (distSq < closestDistSq)
+                        {
+                            closestDistSq = distSq;
+                            setTarget(opposingMobs.getEntities()[i]);
+                        }
+                    }
                 }
-                
             }
         }
     }
@@ -145,17 +191,79 @@ void Entity::pickTarget()
 
 bool Entity::targetInRange()
 {
-    if (!!m_pTarget)
+    const Entity* pTarget = target();
+    if (!!pTarget)
     {
-        float range = m_Stats.getAttackRange();
+        float range = m_Data.m_AttackRange;
 
-        if (m_Stats.getDamageType() == iEntityStats::Melee)
+        if (m_Data.m_DamageType == iEntityStats::Melee)
         {
-            range += ((m_Stats.getSize() + m_pTarget->getStats().getSize()) / 2.f);
+            range += ((m_Data.m_Size + pTarget->getStatsData().m_Size) / 2.f);
         }
 
-        return m_Pos.distSqr(m_pTarget->getPosition()) <= (range * range);
+        return pos().distSqr(pTarget->getPosition()) <= (range * range);
     }
 
     return false;
 }
+
+Entity* Entity::target() const
+{
+    return m_Game.getEntity(m_pStore->m_Target[m_Index]);
+}
+
+void Entity::setTarget(const Entity* pTarget)
+{
+    m_pStore->m_Target[m_Index] = pTarget ? pTarget->getHandle() : EntityHandle();
+}
+
+void Entity::saveState(EntitySnapshot& out) const
+{
+    out.m_Handle = m_Handle;
+    out.m_Id = id;
+    out.m_StatsIndex = m_pStore->m_StatsIndex[m_Index];
+    out.m_Pos = pos();
+    out.m_Health = health();
+    const Entity* pTarget = target();
+    out.m_Target = pTarget ? pTarget->getHandle() : EntityHandle();
+    out.m_TimeSinceAttack = m_pStore->m_TimeSinceAttack[m_Index];
+    out.m_bHidden = isHidden();
+    out.m_bTargetLock = m_bTargetLock;
+    out.m_bInSpringAttackRange = isInSpringAttackRange;
+
+    out.m_TimeHiding = 0.f;
+    out.m_bFollowingGiant = false;
+    out.m_bFollowingBuilding = false;
+    out.m_FriendlyGiant = EntityHandle();
+    out.m_FriendlyBuilding = EntityHandle();
+}
+
+void Entity::loadState(const EntitySnapshot& in)
+{
+    assert(in.m_Handle == m_Handle);
+    assert(in.m_StatsIndex == m_pStore->m_StatsIndex[m_Index]);
+
+    id = in.m_Id;
+    pos() = in.m_Pos;
+    health() = in.m_Health;
+    m_pStore->m_Target[m_Index] = in.m_Target;
+    timeSinceAttack() = in.m_TimeSinceAttack;
+    setHidden(in.m_bHidden);
+    m_bTargetLock = in.m_bTargetLock;
+    isInSpringAttackRange = in.m_bInSpringAttackRange;
+}
+
+void Entity::hashState(StateHash& hash) const
+{
+    hash.add(m_Handle);
+    hash.add(id);
+    hash.add(m_pStore->m_StatsIndex[m_Index]);
+    hash.add(pos());
+    hash.add(health());
+    const Entity* pTarget = target();
+    hash.add(pTarget ? pTarget->getHandle() : EntityHandle());
+    hash.add(m_pStore->m_TimeSinceAttack[m_Index]);
+    hash.add(isHidden());
+    hash.add(m_bTargetLock);
+    hash.add(isInSpringAttackRange);
+}
@@ -22,56 +22,110 @@
 
 #pragma once
 
+#include "EntityHandle.h"
 #include "EntityStats.h"
+#include "EntityStore.h"
+#include "GameSnapshot.h"
 #include "iPlayer.h"
+#include "StatsTables.h"
 #include "Vec2.h"
 
+class Game;
+class StateHash;
+
 class Entity 
 {
 
 public:
-    Entity(const iEntityStats& stats, const Vec2& pos, bool isNorth);
+    // NOTE: the entity's state (position, health, target, etc.) lives in a 
+    // slot in the store, which must outlive the entity.  So must the game.
+    Entity(Game& game, EntityStore& store, const EntityHandle& handle, const iEntityStats& stats, const Vec2& pos, bool isNorth);
     virtual ~Entity() {}
 
     virtual const iEntityStats& getStats() const { return m_Stats; }
 
-    virtual void tick(float deltaTSec);
+    // The same stats, as a row of plain data.  Use this in the inner loops.
+    const EntityStatsData& getStatsData() const { return m_Data; }
+
+    // Each tick is done in two phases, for every entity at once (see 
+    // Game::tick()).  decide() picks our target and works out whether we'll 
+    // attack it and where we'll move to, from the state as it was at the 
+    // start of the phase.  It only writes to our own state, so every entity
+    // can decide at the same time, on any thread.  apply() then carries out
+    // the decision: deals the damage and moves us.
+    virtual void decide(float deltaTSec);
+    void apply();
 
     virtual bool isNorth() const { return m_bNorth; }
 
-    virtual bool isDead() const { return m_Health <= 0; }
-    virtual int getHealth() const { return m_Health; }
-    void takeDamage(int dmg) { m_Health -= dmg; }
+    bool isDead() const { return health() <= 0; }
+    int getHealth() const { return health(); }
+    void takeDamage(int dmg) { health() -= dmg; }
 
-    virtual const Vec2& getPosition() const { return m_Pos; }
-    virtual const Entity* getTarget() const { return m_pTarget; }
+    const Vec2& getPosition() const { return pos(); }
+    const Entity* getTarget() const { return target(); }
     virtual const int getId() const { return id; }
+
+    // A reference to us that can safely outlive us.  See EntityHandle.
+    const EntityHandle& getHandle() const { return m_Handle; }
     // Hidden entities will appear faded if they belong to the South player, and will
     // not be rendered at all if they belong to the North player.
-    virtual bool isHidden() const { return false; }
+    bool isHidden() const { return m_pStore->m_Hidden[m_Index] != 0; }
+
+    // Called once at the start of each game tick, before anybody acts, to 
+    // work out whether the entity is hidden.  Buildings never hide.
+    virtual void updateVisibility(float deltaTSec) {}
+
+    iPlayer::EntityData getData() const { return iPlayer::EntityData(m_Stats, health(), pos()); }
+
+    // Copies our state out to a snapshot, or back in from one.  Handles to
+    // entities that have been freed are saved as null.
+    virtual void saveState(EntitySnapshot& out) const;
+    virtual void loadState(const EntitySnapshot& in);
 
-    iPlayer::EntityData getData() const { return iPlayer::EntityData(m_Stats, m_Health, m_Pos); }
+    // Folds everything saveState() would save into the hash.
+    virtual void hashState(StateHash& hash) const;
 
 protected:
     void pickTarget();
     bool targetInRange();
 
+    // Accessors for our slot in the store.
+    Vec2& pos() { return m_pStore->m_Pos[m_Index]; }
+    const Vec2& pos() const { return m_pStore->m_Pos[m_Index]; }
+    int& health() { return m_pStore->m_Health[m_Index]; }
+    const int& health() const { return m_pStore->m_Health[m_Index]; }
+    // Our target, or NULL if we don't have one or it has been freed.
+    Entity* target() const;
+    void setTarget(const Entity* pTarget);
+    float& timeSinceAttack() { return m_pStore->m_TimeSinceAttack[m_Index]; }
+    // Where we'll be once the tick is applied.  Moving writes this, rather 
+    // than pos(), so that everybody else still sees where we were.
+    Vec2& nextPos() { return m_pStore->m_NextPos[m_Index]; }
+    void setHidden(bool bHidden) { m_pStore->m_Hidden[m_Index] = bHidden ? 1 : 0; }
+
     // Flag whether the entity has a target in spring attack range
     bool isInSpringAttackRange = false;
 
 protected:
+    Game& m_Game;
     const iEntityStats& m_Stats;
+    const EntityStatsData& m_Data;
     bool m_bNorth;
-    int m_Health;
-    Vec2 m_Pos;
     // Entity has an individual id.
     int id;
     
-
-    // Our target will be the closest target (may change every tick) until
-    //  we attack it.  Once we attack a target, we stay locked on it until
-    //  it dies
-    Entity* m_pTarget;
+    // Our target (in the store) will be the closest target (may change every
+    //  tick) until we attack it.  Once we attack a target, we stay locked on
+    //  it until it dies
     bool m_bTargetLock;
-    float m_TimeSinceAttack;
+
+private:
+    EntityHandle m_Handle;
+
+    // The store moves us between slots (and stores) as entities die.
+    friend class EntityStore;
+
+    EntityStore* m_pStore;
+    unsigned int m_Index;
 };
@@ -0,0 +1,135 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "EntityStore.h"
+
+#include "Entity.h"
+#include <assert.h>
+
+EntityStore::EntityStore(bool bBuildings)
+    : m_bBuildings(bBuildings)
+{
+}
+
+void EntityStore::reserve(unsigned int n)
+{
+    m_Entities.reserve(n);
+    m_Pos.reserve(n);
+    m_Health.reserve(n);
+    m_StatsIndex.reserve(n);
+    m_Target.reserve(n);
+    m_TimeSinceAttack.reserve(n);
+    m_Hidden.reserve(n);
+    m_NextPos.reserve(n);
+    m_AttackTarget.reserve(n);
+    m_AttackDamage.reserve(n);
+}
+
+const iEntityStats& EntityStore::getStats(unsigned int i) const
+{
+    if (m_bBuildings)
+    {
+        return iEntityStats::getBuildingStats((iEntityStats::BuildingType)m_StatsIndex[i]);
+    }
+
+    return iEntityStats::getStats((iEntityStats::MobType)m_StatsIndex[i]);
+}
+
+unsigned int EntityStore::add(Entity* pEntity, const iEntityStats& stats, const Vec2& pos)
+{
+    const unsigned int index = size();
+
+    m_Entities.push_back(pEntity);
+    m_Pos.push_back(pos);
+    m_Health.push_back(stats.getMaxHealth());
+    m_StatsIndex.push_back(m_bBuildings ? (int)stats.getBuildingType() : (int)stats.getMobType());
+    m_Target.push_back(EntityHandle());
+    m_TimeSinceAttack.push_back(0.f);
+    m_Hidden.push_back(0);
+    m_NextPos.push_back(pos);
+    m_AttackTarget.push_back(EntityHandle());
+    m_AttackDamage.push_back(0);
+
+    return index;
+}
+
+void EntityStore::removeDead(std::vector<Entity*>& outDead)
+{
+    unsigned int newIndex = 0;
+    for (unsigned int oldIndex = 0; oldIndex < size(); ++oldIndex)
+    {
+        Entity* pEntity = m_Entities[oldIndex];
+        if (m_Health[oldIndex] > 0)
+        {
+            if (newIndex != oldIndex)
+            {
+                copySlot(oldIndex, newIndex);
+                pEntity->m_Index = newIndex;
+            }
+            ++newIndex;
+        }
+        else
+        {
+            outDead.push_back(pEntity);
+        }
+    }
+
+    assert(newIndex <= size());
+    resize(newIndex);
+}
+
+void EntityStore::deleteAll()
+{
+    for (Entity* pEntity : m_Entities)
+    {
+        delete pEntity;
+    }
+    resize(0);
+}
+
+void EntityStore::copySlot(unsigned int from, unsigned int to)
+{
+    m_Entities[to] = m_Entities[from];
+    m_Pos[to] = m_Pos[from];
+    m_Health[to] = m_Health[from];
+    m_StatsIndex[to] = m_StatsIndex[from];
+    m_Target[to] = m_Target[from];
+    m_TimeSinceAttack[to] = m_TimeSinceAttack[from];
+    m_Hidden[to] = m_Hidden[from];
+    m_NextPos[to] = m_NextPos[from];
+    m_AttackTarget[to] = m_AttackTarget[from];
+    m_AttackDamage[to] = m_AttackDamage[from];
+}
+
+void EntityStore::resize(unsigned int n)
+{
+    m_Entities.resize(n, NULL);
+    m_Pos.resize(n);
+    m_Health.resize(n, 0);
+    m_StatsIndex.resize(n, 0);
+    m_Target.resize(n);
+    m_TimeSinceAttack.resize(n, 0.f);
+    m_Hidden.resize(n, 0);
+    m_NextPos.resize(n);
+    m_AttackTarget.resize(n);
+    m_AttackDamage.resize(n, 0);
+}
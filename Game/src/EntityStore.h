@@ -0,0 +1,105 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "EntityStats.h"
+#include "StatsTables.h"
+#include "Vec2.h"
+#include <vector>
+
+class Entity;
+
+// Structure-of-arrays storage for one player's mobs (or buildings).  Slot i of
+// every array belongs to the same entity, and the Entity objects themselves 
+// just hold their slot index.  The hot loops (ticking, targeting, drawing)
+// walk these arrays directly, rather than chasing an Entity pointer and then
+// making a virtual call for every field they read.
+//   Slots are kept packed: removeDead() hands the dead entities back to the
+// caller and slides the live ones down, updating their slot indices as it goes.
+class EntityStore
+{
+public:
+    explicit EntityStore(bool bBuildings);
+
+    unsigned int size() const { return (unsigned int)m_Entities.size(); }
+
+    // Sets aside room for n slots, so that add() won't reallocate until then.
+    void reserve(unsigned int n);
+
+    // Gets the stats for slot i, using the stats index.
+    const iEntityStats& getStats(unsigned int i) const;
+    const EntityStatsData& getStatsData(unsigned int i) const
+    {
+        return m_bBuildings ? BUILDING_STATS[m_StatsIndex[i]] : MOB_STATS[m_StatsIndex[i]];
+    }
+
+    // NOTE: the store doesn't own the entities - see deleteAll().
+    const std::vector<Entity*>& getEntities() const { return m_Entities; }
+    const std::vector<Vec2>& getPositions() const { return m_Pos; }
+    const std::vector<int>& getHealths() const { return m_Health; }
+    const std::vector<int>& getStatsIndices() const { return m_StatsIndex; }
+    const std::vector<EntityHandle>& getTargets() const { return m_Target; }
+    const std::vector<float>& getAttackTimers() const { return m_TimeSinceAttack; }
+    const std::vector<unsigned char>& getHidden() const { return m_Hidden; }
+
+    // Adds a slot for the entity (which must use this store) and returns its index.
+    unsigned int add(Entity* pEntity, const iEntityStats& stats, const Vec2& pos);
+
+    // Removes any dead entities, appending them (in order) to outDead, and
+    // packs the live ones down.  The dead entities no longer have a slot, so
+    // the caller should free them straight away.
+    void removeDead(std::vector<Entity*>& outDead);
+
+    // Deletes all of the entities and empties the store.  This is for stores
+    // whose entities were allocated with new (i.e. the buildings).
+    void deleteAll();
+
+    // Empties the store without touching the entities (because whoever owns 
+    // them has already destroyed them - see Player::loadState()).
+    void clear() { resize(0); }
+
+private:
+    // Entity reads and writes its own slot directly.
+    friend class Entity;
+
+    void copySlot(unsigned int from, unsigned int to);
+    void resize(unsigned int n);
+
+private:
+    bool m_bBuildings;
+
+    std::vector<Entity*> m_Entities;
+    std::vector<Vec2> m_Pos;
+    std::vector<int> m_Health;
+    std::vector<int> m_StatsIndex;          // a MobType or BuildingType
+    std::vector<EntityHandle> m_Target;
+    std::vector<float> m_TimeSinceAttack;
+    std::vector<unsigned char> m_Hidden;    // a bool, but without vector<bool>
+
+    // What each entity decided to do this tick, until it's applied.  See 
+    // Entity::decide().
+    std::vector<Vec2> m_NextPos;
+    std::vector<EntityHandle> m_AttackTarget;
+    std::vector<int> m_AttackDamage;        // 0 => not attacking
+};
@@ -0,0 +1,183 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FlowField.h"
+
+#include "StatsTables.h"
+#include <algorithm>
+#include <float.h>
+#include <functional>
+#include <limits.h>
+#include <math.h>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Step costs, in tenths of a tile.
+static const int kStraightCost = 10;
+static const int kDiagonalCost = 14;
+static const int kBlockedCost = 1000;       // extra for stepping into the river or a tower
+
+static const int kNumTiles = GAME_GRID_WIDTH * GAME_GRID_HEIGHT;
+
+static Vec2 tileCenter(int x, int y)
+{
+    return Vec2((float)x + 0.5f, (float)y + 0.5f);
+}
+
+static bool isOnBridge(float x)
+{
+    return (fabsf(x - LEFT_BRIDGE_CENTER_X) < (BRIDGE_WIDTH / 2.f)) ||
+           (fabsf(x - RIGHT_BRIDGE_CENTER_X) < (BRIDGE_WIDTH / 2.f));
+}
+
+static bool isUnderBuilding(const Vec2& pt, const Vec2& buildingPos, iEntityStats::BuildingType type)
+{
+    const float halfSize = BUILDING_STATS[type].m_Size / 2.f;
+    return (fabsf(pt.x - buildingPos.x) < halfSize) && (fabsf(pt.y - buildingPos.y) < halfSize);
+}
+
+// Whether mobs should stay out of a tile (because it's river, or under a tower).
+static bool isBlocked(int x, int y)
+{
+    const Vec2 center = tileCenter(x, y);
+    if ((center.y > RIVER_TOP_Y) && (center.y < RIVER_BOT_Y) && !isOnBridge(center.x))
+    {
+        return true;
+    }
+
+    const float princessYs[] = { NorthPrincessY, SouthPrincessY };
+    for (float princessY : princessYs)
+    {
+        if (isUnderBuilding(center, Vec2(PrincessLeftX, princessY), iEntityStats::Princess) ||
+            isUnderBuilding(center, Vec2(PrincessRightX, princessY), iEntityStats::Princess))
+        {
+            return true;
+        }
+    }
+
+    return isUnderBuilding(center, Vec2(KingX, NorthKingY), iEntityStats::King) ||
+           isUnderBuilding(center, Vec2(KingX, SouthKingY), iEntityStats::King);
+}
+
+// The shortest sight radius of any mob.  The path ends where every mob can
+// see the King.
+static float getMinMobSightRadius()
+{
+    float minSight = FLT_MAX;
+    for (int i = 0; i < iEntityStats::numMobTypes; ++i)
+    {
+        minSight = std::min(minSight, MOB_STATS[i].m_SightRadius);
+    }
+    return minSight;
+}
+
+const FlowField& FlowField::get(bool bNorth)
+{
+    // Built on first use, thread safely (as getMaxMobSize() in Mob.cpp is).
+    static const FlowField s_NorthField(true);
+    static const FlowField s_SouthField(false);
+    return bNorth ? s_NorthField : s_SouthField;
+}
+
+FlowField::FlowField(bool bNorth)
+{
+    bool blocked[kNumTiles];
+    for (int y = 0; y < GAME_GRID_HEIGHT; ++y)
+    {
+        for (int x = 0; x < GAME_GRID_WIDTH; ++x)
+        {
+            blocked[y * GAME_GRID_WIDTH + x] = isBlocked(x, y);
+        }
+    }
+
+    // North's mobs head for the South King, and vice versa.
+    const Vec2 enemyKing(KingX, bNorth ? SouthKingY : NorthKingY);
+    const float sight = getMinMobSightRadius();
+
+    typedef std::pair<int, int> QueueEntry;       // distance, tile
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > open;
+
+    for (int y = 0; y < GAME_GRID_HEIGHT; ++y)
+    {
+        for (int x = 0; x < GAME_GRID_WIDTH; ++x)
+        {
+            const int i = y * GAME_GRID_WIDTH + x;
+            m_NextPoint[i] = tileCenter(x, y);
+            m_Distance[i] = INT_MAX;
+
+            if (!blocked[i] && (tileCenter(x, y).distSqr(enemyKing) < (sight * sight)))
+            {
+                m_Distance[i] = 0;
+                open.push(QueueEntry(0, i));
+            }
+        }
+    }
+
+    // We search outward from the King, so each tile we reach steps into the 
+    // one we reached it from, and pays for entering that tile.
+    while (!open.empty())
+    {
+        const QueueEntry entry = open.top();
+        open.pop();
+
+        const int to = entry.second;
+        if (entry.first > m_Distance[to])
+        {
+            continue;   // already reached more cheaply
+        }
+
+        const int toX = to % GAME_GRID_WIDTH;
+        const int toY = to / GAME_GRID_WIDTH;
+        const int enterCost = blocked[to] ? kBlockedCost : 0;
+
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                const int fromX = toX + dx;
+                const int fromY = toY + dy;
+                if (((dx == 0) && (dy == 0)) || 
+                    (fromX < 0) || (fromX >= GAME_GRID_WIDTH) || (fromY < 0) || (fromY >= GAME_GRID_HEIGHT))
+                {
+                    continue;
+                }
+
+                // Don't cut corners past the river or a tower.
+                const bool bDiagonal = (dx != 0) && (dy != 0);
+                if (bDiagonal && (blocked[toY * GAME_GRID_WIDTH + fromX] || blocked[fromY * GAME_GRID_WIDTH + toX]))
+                {
+                    continue;
+                }
+
+                const int from = fromY * GAME_GRID_WIDTH + fromX;
+                const int dist = entry.first + (bDiagonal ? kDiagonalCost : kStraightCost) + enterCost;
+                if (dist < m_Distance[from])
+                {
+                    m_Distance[from] = dist;
+                    m_NextPoint[from] = tileCenter(toX, toY);
+                    open.push(QueueEntry(dist, from));
+                }
+            }
+        }
+    }
+}
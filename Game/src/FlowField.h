@@ -0,0 +1,62 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Constants.h"
+#include "Vec2.h"
+
+// The way to the enemy King tower from every tile of the arena, for the mobs 
+// of one side.  The arena never changes shape, so the fields for both sides
+// are worked out once (on first use) and shared by every game.  A mob with 
+// nothing to chase just looks up the tile it's in and heads for the point it
+// gets back - there's no searching at run time.
+//   The field is the result of a Dijkstra search out from the tiles next to
+// the enemy King.  The river can only be crossed on the bridges, and mobs go
+// around the towers rather than through them.  Those tiles aren't completely
+// off limits, just very expensive, so a mob that has been pushed into the 
+// river (or placed on a tower) still gets the shortest way out.
+//   Towers don't leave the field when they die, so mobs keep walking around 
+// the rubble.  That's fine, since any mob that gets that close to a tower is
+// chasing something by then.
+class FlowField
+{
+public:
+    // The field for the mobs of one side.
+    static const FlowField& get(bool bNorth);
+
+    // Where a mob at pos should head next: the center of the next tile along
+    // the path, or the center of its own tile once it's in sight of the King.
+    // Positions off the arena use the nearest tile.
+    const Vec2& getNextPoint(const Vec2& pos) const { return m_NextPoint[toTileIndex(pos)]; }
+
+    // How far (in tenths of a tile) the tile holding pos is from the end of
+    // the path.  Detours through the river or a tower count as very far.
+    int getDistance(const Vec2& pos) const { return m_Distance[toTileIndex(pos)]; }
+
+private:
+    explicit FlowField(bool bNorth);
+
+private:
+    Vec2 m_NextPoint[GAME_GRID_WIDTH * GAME_GRID_HEIGHT];
+    int m_Distance[GAME_GRID_WIDTH * GAME_GRID_HEIGHT];
+};
@@ -0,0 +1,87 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
+
+FrameArena::FrameArena()
+    : m_CurrentBlock(0)
+    , m_Offset(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (Block& block : m_Blocks)
+    {
+        delete[] block.m_pData;
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    assert((alignment & (alignment - 1)) == 0);
+
+    // Try the current block, then any later ones we made on earlier ticks.
+    for (; m_CurrentBlock < m_Blocks.size(); ++m_CurrentBlock, m_Offset = 0)
+    {
+        const Block& block = m_Blocks[m_CurrentBlock];
+        const uintptr_t start = (uintptr_t)block.m_pData + m_Offset;
+        const uintptr_t aligned = (start + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+        const size_t end = (size_t)(aligned - (uintptr_t)block.m_pData) + size;
+        if (end <= block.m_Size)
+        {
+            m_Offset = end;
+            return (void*)aligned;
+        }
+    }
+
+    // We've run out, so add a block (big enough for this, whatever it is).
+    // NOTE: new[] hands back memory aligned for any fundamental type.
+    Block block;
+    block.m_Size = std::max(FRAME_ARENA_BLOCK_SIZE, size + alignment);
+    block.m_pData = new char[block.m_Size];
+    m_Blocks.push_back(block);
+
+    m_CurrentBlock = m_Blocks.size() - 1;
+    m_Offset = 0;
+    return allocate(size, alignment);
+}
+
+void FrameArena::reset()
+{
+    m_CurrentBlock = 0;
+    m_Offset = 0;
+}
+
+size_t FrameArena::getCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block& block : m_Blocks)
+    {
+        capacity += block.m_Size;
+    }
+    return capacity;
+}
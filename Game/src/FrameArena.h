@@ -0,0 +1,101 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+const size_t FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+
+// A bump allocator for scratch space that only lives for one tick.  
+// Allocating just bumps a pointer, nothing is freed on its own, and reset()
+// (at the end of Game::tick()) rewinds the whole arena at once.  The blocks 
+// are kept from tick to tick, so once the arena has grown to fit the busiest
+// tick, ticks don't touch the heap for scratch space at all.
+//   Each Game has an arena for each of its tick threads (see 
+// Game::getFrameArena()), so an arena is only ever used from one thread.
+class FrameArena
+{
+public:
+    FrameArena();
+    ~FrameArena();
+
+    // NOTE: alignment must be a power of 2.
+    void* allocate(size_t size, size_t alignment);
+
+    // Frees everything allocated since the last reset, all at once.  Anything
+    // still using that memory is left dangling.
+    void reset();
+
+    // How much memory the arena holds on to, in bytes.
+    size_t getCapacity() const;
+
+private:
+    struct Block
+    {
+        char* m_pData;
+        size_t m_Size;
+    };
+
+    std::vector<Block> m_Blocks;
+    size_t m_CurrentBlock;          // the block we're allocating from
+    size_t m_Offset;                // how much of it is used
+
+private:
+    // DELIBERATELY UNDEFINED
+    FrameArena(const FrameArena& rhs);
+    FrameArena& operator=(const FrameArena& rhs);
+};
+
+// An STL allocator that allocates from a FrameArena, so that containers of 
+// scratch data can be used in the tick without going to the heap.  
+// Deallocating does nothing - the memory comes back when the arena is reset.
+template <class T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena& arena) : m_pArena(&arena) {}
+
+    template <class U>
+    FrameAllocator(const FrameAllocator<U>& rhs) : m_pArena(rhs.getArena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(m_pArena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    FrameArena* getArena() const { return m_pArena; }
+
+    template <class U>
+    bool operator==(const FrameAllocator<U>& rhs) const { return m_pArena == rhs.getArena(); }
+    template <class U>
+    bool operator!=(const FrameAllocator<U>& rhs) const { return m_pArena != rhs.getArena(); }
+
+private:
+    FrameArena* m_pArena;
+};
+
+// A vector whose storage comes from a FrameArena.  Give it the arena when you
+// make it, and don't keep it past the end of the tick.
+template <class T>
+using FrameVector = std::vector<T, FrameAllocator<T> >;
@@ -23,38 +23,279 @@
 #include "Game.h"
 
 #include <cmath>
+#include "AllocationCounter.h"
 #include "Building.h"
 #include "Constants.h"
 #include "Controller_UI.h"
 #include "Controller_AI_KevinDill.h"
+#include "GameSnapshot.h"
+#include "Log.h"
 #include "Mob.h"
 #include "Player.h"
-
-Game* Singleton<Game>::s_Obj = NULL;
+#include "Profiler.h"
+#include "Replay.h"
+#include "StateHash.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 Game::Game()
     : gameOverState(0) // No winner at start of game
+    , m_NextEntityId(0)
+    , m_pRecorder(NULL)
+    , m_StateHash(0)
+    , m_pWorkers(NULL)
+    , m_LastTickAllocations(0)
 {
+    m_FrameArenas.push_back(new FrameArena);
+
     // FinalProject: This is where you specify which controllers to use - for 
     // instance, if you make two instances of your AI then it will play 
     // itself, or if you make one the UI and one your AI then you can play
     // against your AI.  If you make the controller NULL then that player
-    // will just passively sit there and let you kill it.
+    // will just passively sit there and let you kill it.  For a tougher 
+    // opponent, try Controller_AI_MCTS.
     buildPlayers(new Controller_AI_KevinDill, new Controller_UI);
 
-    buildWaypoints();
+    m_StateHash = computeStateHash();
+}
+
+Game::Game(iController* pNorthControl, iController* pSouthControl)
+    : gameOverState(0) // No winner at start of game
+    , m_NextEntityId(0)
+    , m_pRecorder(NULL)
+    , m_StateHash(0)
+    , m_pWorkers(NULL)
+    , m_LastTickAllocations(0)
+{
+    m_FrameArenas.push_back(new FrameArena);
+
+    buildPlayers(pNorthControl, pSouthControl);
+
+    m_StateHash = computeStateHash();
 }
 
 Game::~Game()
 {
     delete m_pNorthPlayer;
     delete m_pSouthPlayer;
+
+    delete m_pWorkers;
+    for (FrameArena* pArena : m_FrameArenas)
+    {
+        delete pArena;
+    }
+}
+
+void Game::setNumThreads(unsigned int numThreads)
+{
+    if (numThreads == 0)
+    {
+        // NOTE: this may be 0 if the number of cores can't be worked out.
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    delete m_pWorkers;
+    m_pWorkers = (numThreads > 1) ? new WorkerPool(numThreads) : NULL;
+
+    while (m_FrameArenas.size() < numThreads)
+    {
+        m_FrameArenas.push_back(new FrameArena);
+    }
+    while (m_FrameArenas.size() > numThreads)
+    {
+        delete m_FrameArenas.back();
+        m_FrameArenas.pop_back();
+    }
+}
+
+unsigned int Game::getNumThreads() const
+{
+    return m_pWorkers ? m_pWorkers->getNumThreads() : 1;
+}
+
+FrameArena& Game::getFrameArena()
+{
+    return *m_FrameArenas[m_pWorkers ? m_pWorkers->getCurrentThread() : 0];
 }
 
 void Game::tick(float deltaTSec)
 {
+    PROFILE_SCOPE("Game::tick");
+
+    // The simulation itself shouldn't touch the heap once it has warmed up,
+    // so count anything that does.  The recorder's log grows as it goes, and
+    // the controllers do what they like (see Player::tick()).
+    //   The count is per thread, so the worker threads add theirs in to 
+    // workerAllocations as they go.
+    const uint64_t startAllocations = AllocationCounter::getCount();
+    std::atomic<uint64_t> workerAllocations(0);
+
+    if (m_pRecorder)
+    {
+        AllocationCounter::ScopedIgnore ignoreRecorder;
+        m_pRecorder->beginTick(deltaTSec);
+    }
+
+    // Hiding is worked out once per tick, so every question about it during 
+    // the tick gets the same answer.
+    {
+        PROFILE_SCOPE("Update visibility");
+        updateVisibility(deltaTSec);
+    }
+
+    // The controllers go first, so that anything they place ticks this tick.
+    // They both see the same state, since nothing has moved yet.
     m_pNorthPlayer->tick(deltaTSec);
     m_pSouthPlayer->tick(deltaTSec);
+
+    // Everybody finds their targets through the mob grids, which hold still
+    // for the whole decide phase, since nobody moves until it's applied.
+    m_NorthMobGrid.rebuild(m_pNorthPlayer->getMobStore());
+    m_SouthMobGrid.rebuild(m_pSouthPlayer->getMobStore());
+
+    m_TickEntities.clear();
+    m_pNorthPlayer->getLiveEntities(m_TickEntities);
+    m_pSouthPlayer->getLiveEntities(m_TickEntities);
+
+    // Deciding only reads the shared state and writes each entity's own, so
+    // the order doesn't matter and neither does the thread.
+    {
+        PROFILE_SCOPE("Decide");
+        if (m_pWorkers)
+        {
+            // NOTE: muting is per thread, so if we're muted (in a Sandbox, 
+            // say) the workers need to be too.
+            Entity* const* pEntities = m_TickEntities.data();
+            const bool bMuted = Log::isMuted();
+            const WorkerPool& workers = *m_pWorkers;
+            m_pWorkers->parallelFor((unsigned int)m_TickEntities.size(), [&](unsigned int i)
+            {
+                const uint64_t startCount = AllocationCounter::getCount();
+                if (bMuted)
+                {
+                    Log::ScopedMute mute;
+                    pEntities[i]->decide(deltaTSec);
+                }
+                else
+                {
+                    pEntities[i]->decide(deltaTSec);
+                }
+
+                // Our own thread's allocations are counted already.
+                const uint64_t count = AllocationCounter::getCount() - startCount;
+                if ((count > 0) && (workers.getCurrentThread() != 0))
+                {
+                    workerAllocations.fetch_add(count, std::memory_order_relaxed);
+                }
+            });
+        }
+        else
+        {
+            for (Entity* pEntity : m_TickEntities)
+            {
+                pEntity->decide(deltaTSec);
+            }
+        }
+    }
+
+    // Applying is done in the same order every time, on this thread, so the 
+    // damage adds up the same way however the decisions were made.  An entity
+    // that dies here still gets to apply its own decision - everybody acts at
+    // once.
+    {
+        PROFILE_SCOPE("Apply");
+        for (Entity* pEntity : m_TickEntities)
+        {
+            pEntity->apply();
+        }
+    }
+
+    m_pNorthPlayer->freeDeadMobs();
+    m_pSouthPlayer->freeDeadMobs();
+
+    m_NorthMobGrid.rebuild(m_pNorthPlayer->getMobStore());
+    m_SouthMobGrid.rebuild(m_pSouthPlayer->getMobStore());
+    {
+        PROFILE_SCOPE("Resolve collisions");
+        resolveCollisions();
+    }
+
+    {
+        PROFILE_SCOPE("Hash state");
+        m_StateHash = computeStateHash();
+    }
+
+    for (FrameArena* pArena : m_FrameArenas)
+    {
+        pArena->reset();
+    }
+
+    m_LastTickAllocations = (unsigned int)((AllocationCounter::getCount() - startAllocations) + workerAllocations.load());
+    if (m_LastTickAllocations > 0)
+    {
+        LOG(System, Debug, "Tick made %u heap allocations\n", m_LastTickAllocations);
+    }
+}
+
+void Game::updateVisibility(float deltaTSec)
+{
+    // Pack up the towers and Giants that Rogues hide behind first.
+    m_pNorthPlayer->updateOccluders();
+    m_pSouthPlayer->updateOccluders();
+
+    const Player* players[] = { m_pNorthPlayer, m_pSouthPlayer };
+    for (const Player* pPlayer : players)
+    {
+        for (Entity* pMob : pPlayer->getMobs())
+        {
+            if (!pMob->isDead())
+            {
+                pMob->updateVisibility(deltaTSec);
+            }
+        }
+    }
+}
+
+void Game::resolveCollisions()
+{
+    // The broadphase is the mob grids: each mob only checks the mobs in the
+    // cells around it, so this is roughly linear in the number of mobs.
+    const Player* players[] = { m_pNorthPlayer, m_pSouthPlayer };
+    for (const Player* pPlayer : players)
+    {
+        for (Entity* pEntity : pPlayer->getMobs())
+        {
+            if (pEntity->isDead())
+            {
+                continue;
+            }
+
+            Mob* pMob = static_cast<Mob*>(pEntity);
+            pMob->checkCollision(m_Collisions);
+
+            for (Mob* pOther : m_Collisions)
+            {
+                // Each pair shows up twice (once from each side), only handle it once.
+                if (pMob->getId() < pOther->getId())
+                {
+                    pMob->processCollision(pOther);
+                }
+            }
+        }
+    }
+}
+
+Entity* Game::getEntity(const EntityHandle& handle) const
+{
+    if (handle.isNull())
+    {
+        return NULL;
+    }
+
+    const Player* pPlayer = handle.m_bNorth ? m_pNorthPlayer : m_pSouthPlayer;
+    return pPlayer->getEntity(handle);
 }
 
 int Game::checkGameOver() {
@@ -79,35 +320,45 @@ int Game::checkGameOver() {
     return gameOverState;
 }
 
-void Game::buildPlayers(iController* pNorthControl, iController* pSouthControl)
+void Game::takeSnapshot(GameSnapshot& outSnapshot) const
 {
-    m_pNorthPlayer = new Player(pNorthControl, true);
-    m_pSouthPlayer = new Player(pSouthControl, false);
+    outSnapshot.m_Entities.clear();
+    m_pNorthPlayer->saveState(outSnapshot.getPlayer(true), outSnapshot.m_Entities);
+    m_pSouthPlayer->saveState(outSnapshot.getPlayer(false), outSnapshot.m_Entities);
+
+    outSnapshot.m_GameOverState = gameOverState;
+    outSnapshot.m_NextEntityId = m_NextEntityId;
 }
 
-void Game::buildWaypoints()
+void Game::restore(const GameSnapshot& snapshot)
 {
-    // The first waypoint is 1 tile toward the center of the princess tower
-    const float princessSize = iEntityStats::getBuildingStats(iEntityStats::Princess).getSize();
-    const Vec2 first(PrincessLeftX + (princessSize / 2.f) + 1.f, NorthPrincessY);
-    const float kingSize = iEntityStats::getBuildingStats(iEntityStats::King).getSize();
+    m_pNorthPlayer->loadState(snapshot.getPlayer(true), snapshot.m_Entities);
+    m_pSouthPlayer->loadState(snapshot.getPlayer(false), snapshot.m_Entities);
 
-    addFourWaypoints(first);
+    // NOTE: recreating the mobs used up entity ids, so set this last.
+    gameOverState = snapshot.m_GameOverState;
+    m_NextEntityId = snapshot.m_NextEntityId;
 
-    for (float y = first.y + WAYPOINT_Y_INCREMENT; y < RIVER_TOP_Y; y += WAYPOINT_Y_INCREMENT)
-    {
-        addFourWaypoints(Vec2(LEFT_BRIDGE_CENTER_X, y));
-    }
-    
+    m_StateHash = computeStateHash();
 }
 
-void Game::addFourWaypoints(Vec2 pt)
+uint64_t Game::computeStateHash() const
 {
-    const float rightX = GAME_GRID_WIDTH - pt.x;
-    const float bottomY = GAME_GRID_HEIGHT - pt.y;
+    // This walks every entity, every tick, rather than keeping the hash up to
+    // date as things change, since the walk is cheap next to the tick: in the
+    // 10,000 mob GameTick world it takes about 0.4ms of a 330ms tick (0.1%),
+    // and at 100 mobs, 4us of 170us.
+    // NOTE: gameOverState is left out.  It only changes when somebody calls
+    // checkGameOver(), and it just follows from the kings' health anyway.
+    StateHash hash;
+    m_pNorthPlayer->hashState(hash);
+    m_pSouthPlayer->hashState(hash);
+    hash.add(m_NextEntityId);
+    return hash.get();
+}
 
-    m_Waypoints.push_back(pt);
-    m_Waypoints.push_back(Vec2(rightX, pt.y));
-    m_Waypoints.push_back(Vec2(pt.x, bottomY));
-    m_Waypoints.push_back(Vec2(rightX, bottomY));
+void Game::buildPlayers(iController* pNorthControl, iController* pSouthControl)
+{
+    m_pNorthPlayer = new Player(*this, pNorthControl, true);
+    m_pSouthPlayer = new Player(*this, pSouthControl, false);
 }
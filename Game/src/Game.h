@@ -22,42 +22,134 @@
 
 #pragma once
 
-#include "Singleton.h"
+#include "EntityHandle.h"
+#include "FrameArena.h"
+#include "SpatialGrid.h"
 #include "Vec2.h"
+#include <stdint.h>
 #include <vector>
 
 class Building;
+class Entity;
+struct GameSnapshot;
 class iController;
 class Mob;
 class Player;
+class ReplayRecorder;
+class WorkerPool;
 
-class Game : public Singleton<Game>
+// One match.  Everything in the match (players, entities, grids) belongs to 
+// its Game and reaches the rest of the world through it, rather than through
+// globals, so any number of Games can run side by side (on different threads,
+// even) - see MatchRunner.
+class Game
 {
 public:
     explicit Game();
+
+    // NOTE: we take ownership of the controllers (either may be NULL)
+    explicit Game(iController* pNorthControl, iController* pSouthControl);
     virtual ~Game();
 
+    // Ticks both players' entities together, in two phases: first every 
+    // entity decides what to do, from the same state, and then the decisions 
+    // are applied in a fixed order.  So neither player gets to act first, and 
+    // the decide phase can be spread across threads without changing the 
+    // result - see setNumThreads().
     void tick(float deltaTSec);
 
+    // How many threads the decide phase runs on: 1 (the default) ticks on the 
+    // calling thread alone, and 0 means one per core.  Any number of threads 
+    // gives the same result.
+    void setNumThreads(unsigned int numThreads);
+    unsigned int getNumThreads() const;
+
     Player& getPlayer(bool bNorth) { return bNorth ? *m_pNorthPlayer : *m_pSouthPlayer; }
+    const Player& getPlayer(bool bNorth) const { return bNorth ? *m_pNorthPlayer : *m_pSouthPlayer; }
+
+    // Returns the entity the handle refers to, or NULL if the handle is null
+    // or the entity has been freed.
+    Entity* getEntity(const EntityHandle& handle) const;
 
-    const std::vector<Vec2>& getWaypoints() const { return m_Waypoints; }
+    // The live mobs of one player (as indices into its mob store), bucketed by
+    // tile.  Only valid during tick().
+    const SpatialGrid& getMobGrid(bool bNorth) const { return bNorth ? m_NorthMobGrid : m_SouthMobGrid; }
 
     int checkGameOver();
 
+    // Copies the complete state of the game into a snapshot, or replaces it
+    // with the state from one.  See GameSnapshot.h.
+    // NOTE: the controllers aren't part of the snapshot.
+    void takeSnapshot(GameSnapshot& outSnapshot) const;
+    void restore(const GameSnapshot& snapshot);
+
+    // Entity ids are unique within a game.
+    int nextEntityId() { return m_NextEntityId++; }
+
+    // If set, every tick and successful placement is recorded.  We don't own
+    // the recorder.  See Replay.h.
+    void setRecorder(ReplayRecorder* pRecorder) { m_pRecorder = pRecorder; }
+    ReplayRecorder* getRecorder() const { return m_pRecorder; }
+
+    // A hash of the complete state of the game, as of the end of the last 
+    // tick (or restore).  Two games that hold the same state have the same
+    // hash.  See StateHash.h.
+    uint64_t getStateHash() const { return m_StateHash; }
+
+    // Scratch memory for the current tick, for the calling thread.  
+    // Everything allocated from it is freed at the end of tick(), so don't 
+    // hold on to it.  See FrameArena.h.
+    FrameArena& getFrameArena();
+
+    // How many heap allocations the last tick made, not counting the 
+    // controllers or the replay recorder.  Always 0 unless the allocation 
+    // counter is compiled in - see AllocationCounter.h.  This includes the 
+    // decide phase's worker threads.
+    unsigned int getLastTickAllocations() const { return m_LastTickAllocations; }
+
 private:
     void buildPlayers(iController* pNorthControl, iController* pSouthControl);
 
-    void buildWaypoints();
-    void addFourWaypoints(Vec2 pt);
+    // Works out which mobs are hidden, before anybody acts.
+    void updateVisibility(float deltaTSec);
+
+    // Pushes apart any mobs that overlap, after everybody has moved.
+    void resolveCollisions();
+
+    uint64_t computeStateHash() const;
 
 private:
     Player* m_pNorthPlayer;
     Player* m_pSouthPlayer;
 
-    std::vector<Vec2> m_Waypoints;
+    SpatialGrid m_NorthMobGrid;
+    SpatialGrid m_SouthMobGrid;
+
+    // Scratch space for tick() and resolveCollisions(), kept around to avoid 
+    // reallocating
+    std::vector<Entity*> m_TickEntities;
+    std::vector<Mob*> m_Collisions;
 
     // Negative => South won, Positive => North won, 0 => no winner yet
     int gameOverState; 
+
+    int m_NextEntityId;
+
+    ReplayRecorder* m_pRecorder;            // may be NULL
+
+    uint64_t m_StateHash;
+
+    WorkerPool* m_pWorkers;                 // owned, NULL => single threaded
+    std::vector<FrameArena*> m_FrameArenas; // owned, one per thread
+    unsigned int m_LastTickAllocations;
+
+    // The micro benchmarks set up the per-tick caches (the mob grids) and
+    // reset the frame arenas themselves.
+    friend struct BenchmarkAccess;
+
+private:
+    // DELIBERATELY UNDEFINED
+    Game(const Game& rhs);
+    Game& operator=(const Game& rhs);
 };
 
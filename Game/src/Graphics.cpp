@@ -2,10 +2,14 @@
 
 #include "Constants.h"
 #include <algorithm>
+#include <string.h>
 
 Graphics* Singleton<Graphics>::s_Obj = NULL;
 
-Graphics::Graphics() {
+Graphics::Graphics()
+	: m_pArena(NULL)
+	, m_pGlyphAtlas(NULL)
+{
 	gWindow = SDL_CreateWindow("Crash Loyal", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, SDL_WINDOW_SHOWN);
 	if (gWindow == NULL) {
 		gRenderer = NULL;
@@ -37,9 +41,13 @@ Graphics::Graphics() {
     // Load in the font 
     sans = TTF_OpenFont("fonts/abelregular.ttf", 36);
     if (!sans) { printf("TTF_OpenFont: %s\n", TTF_GetError()); }
+
+    buildGlyphAtlas();
 }
 
 Graphics::~Graphics() {
+    if (m_pArena) { SDL_DestroyTexture(m_pArena); }
+    if (m_pGlyphAtlas) { SDL_DestroyTexture(m_pGlyphAtlas); }
 	SDL_DestroyRenderer(gRenderer);
 	SDL_DestroyWindow(gWindow);
 }
@@ -48,56 +56,115 @@ void Graphics::render() {
     SDL_RenderPresent(gRenderer);
 }
 
+bool Graphics::isVSynced() const {
+    SDL_RendererInfo info;
+    if (!gRenderer || (SDL_GetRendererInfo(gRenderer, &info) != 0)) {
+        return false;
+    }
+    return (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+}
+
 void Graphics::resetFrame() {
+    if (m_pArena || buildArena()) {
+        SDL_Rect arenaRect = { 0, 0, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS };
+        SDL_RenderCopy(gRenderer, m_pArena, NULL, &arenaRect);
+    }
+    else {
+        drawBG();
+        drawUI();
+    }
+}
+
+void Graphics::handleEvent(const SDL_Event& e) {
+    // The contents of target textures are lost when this happens, and a new
+    // window size may need a new layout - either way, build the arena again.
+    const bool bResized = (e.type == SDL_WINDOWEVENT) && (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED);
+    if (bResized || (e.type == SDL_RENDER_TARGETS_RESET) || (e.type == SDL_RENDER_DEVICE_RESET)) {
+        if (m_pArena) {
+            SDL_DestroyTexture(m_pArena);
+            m_pArena = NULL;
+        }
+    }
+
+    // A device reset loses every texture, so the glyphs need rendering again
+    // too (before the arena is rebuilt, since it has text on it).
+    if (e.type == SDL_RENDER_DEVICE_RESET) {
+        buildGlyphAtlas();
+    }
+}
+
+bool Graphics::buildArena() {
+    if (!gRenderer || !SDL_RenderTargetSupported(gRenderer)) { return false; }
+
+    m_pArena = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+        SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS);
+    if (!m_pArena) { 
+        printf("Arena texture could not be created! SDL Error: %s\n", SDL_GetError()); 
+        return false;
+    }
+
+    // Copy it straight over whatever is there, as drawBG() does.
+    SDL_SetTextureBlendMode(m_pArena, SDL_BLENDMODE_NONE);
+
+    SDL_SetRenderTarget(gRenderer, m_pArena);
     drawBG();
     drawUI();
+    SDL_SetRenderTarget(gRenderer, NULL);
+
+    return true;
 }
 
-void Graphics::drawMob(Entity* m)
+void Graphics::drawMobs(const std::vector<RenderEntity>& mobs)
 {
-    // Project 2: Comment this out if you want Rogues to be visible for debugging
-    if (m->isNorth() && m->isHidden())
-        return;
+    for (const RenderEntity& mob : mobs)
+    {
+        if (mob.m_Health <= 0)
+            continue;
 
-	int alpha = healthToAlpha(m);
+        // Project 2: Comment this out if you want Rogues to be visible for debugging
+        if (mob.m_bNorth && mob.m_bHidden)
+            continue;
 
-    if (m->isNorth())
-    {
-        if (!m->isHidden())
-        {
-            SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, alpha);
-        }
-        else
-        {
-            SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xA0, 0xA0, alpha);
-        }
-    }
-    else
-    {
-        if (!m->isHidden())
+        int alpha = healthToAlpha(mob.m_Health, mob.m_MaxHealth);
+
+        if (mob.m_bNorth)
         {
-            SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, alpha);
+            if (!mob.m_bHidden)
+            {
+                SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, alpha);
+            }
+            else
+            {
+                SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xA0, 0xA0, alpha);
+            }
         }
         else
         {
-            SDL_SetRenderDrawColor(gRenderer, 0xA0, 0xA0, 0xFF, alpha);
+            if (!mob.m_bHidden)
+            {
+                SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, alpha);
+            }
+            else
+            {
+                SDL_SetRenderDrawColor(gRenderer, 0xA0, 0xA0, 0xFF, alpha);
+            }
         }
-    }
 
-	float centerX = m->getPosition().x * PIXELS_PER_METER;
-	float centerY = m->getPosition().y * PIXELS_PER_METER;
-	float squareSize = m->getStats().getSize() * PIXELS_PER_METER;
+        float centerX = mob.m_Pos.x * PIXELS_PER_METER;
+        float centerY = mob.m_Pos.y * PIXELS_PER_METER;
+        float squareSize = mob.m_Size * PIXELS_PER_METER;
 
-	drawSquare(centerX, centerY, squareSize);
+        drawSquare(centerX, centerY, squareSize);
 
-	SDL_Rect stringRect = {
-		(int)(centerX - (squareSize / 2.f)),
-		(int)(centerY - (squareSize / 2.f)),
-		(int)squareSize,
-		(int)squareSize
-	};
-	SDL_Color stringColor = { 0, 0, 0, 255 };
-	drawText(m->getStats().getDisplayLetter(), stringRect, stringColor);
+        SDL_Rect stringRect = {
+            (int)(centerX - (squareSize / 2.f)),
+            (int)(centerY - (squareSize / 2.f)),
+            (int)squareSize,
+            (int)squareSize
+        };
+        SDL_Color stringColor = { 0, 0, 0, 255 };
+        drawText(mob.m_DisplayLetter, stringRect, stringColor);
+    }
 }
 
 
@@ -112,48 +179,111 @@ void Graphics::drawSquare(float centerX, float centerY, float size) {
     SDL_RenderFillRect(gRenderer, &rect);
 }
 
-int Graphics::healthToAlpha(const Entity* e)
+int Graphics::healthToAlpha(int health, int maxHealth)
 {
-    float health = std::max(0.f, (float)e->getHealth());
-    float maxHealth = (float)e->getStats().getMaxHealth();
-    return (int)(((health / maxHealth) * 200.f) + 55.f);
+    float fHealth = std::max(0.f, (float)health);
+    return (int)(((fHealth / (float)maxHealth) * 200.f) + 55.f);
 }
 
-void Graphics::drawBuilding(Entity* b) {
-    int alpha = healthToAlpha(b);
+void Graphics::drawBuilding(const RenderEntity& b) {
+    int alpha = healthToAlpha(b.m_Health, b.m_MaxHealth);
 
-    if (b->isDead())
+    if (b.m_Health <= 0)
         SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 100);
-    else if (b->isNorth())
+    else if (b.m_bNorth)
         SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, alpha);
     else
         SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, alpha);
 
-    drawSquare(b->getPosition().x * PIXELS_PER_METER,
-        b->getPosition().y * PIXELS_PER_METER,
-        b->getStats().getSize() * PIXELS_PER_METER);
+    drawSquare(b.m_Pos.x * PIXELS_PER_METER,
+        b.m_Pos.y * PIXELS_PER_METER,
+        b.m_Size * PIXELS_PER_METER);
+}
+
+void Graphics::buildGlyphAtlas() {
+    if (m_pGlyphAtlas) {
+        SDL_DestroyTexture(m_pGlyphAtlas);
+        m_pGlyphAtlas = NULL;
+    }
+    memset(m_GlyphRects, 0, sizeof(m_GlyphRects));
+    if (!sans || !gRenderer) { return; }
+
+    // Render each glyph on its own, and lay them out in a single row.
+    const SDL_Color white = { 255, 255, 255, 255 };
+    const int numGlyphs = LAST_GLYPH - FIRST_GLYPH + 1;
+    SDL_Surface* glyphSurfaces[numGlyphs];
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    for (int i = 0; i < numGlyphs; ++i) {
+        glyphSurfaces[i] = TTF_RenderGlyph_Solid(sans, (Uint16)(FIRST_GLYPH + i), white);
+        if (!glyphSurfaces[i]) { continue; }
+
+        SDL_Rect rect = { atlasWidth, 0, glyphSurfaces[i]->w, glyphSurfaces[i]->h };
+        m_GlyphRects[i] = rect;
+        atlasWidth += glyphSurfaces[i]->w;
+        atlasHeight = std::max(atlasHeight, glyphSurfaces[i]->h);
+    }
+
+    // Blitting the (color keyed) glyphs onto a transparent surface leaves us
+    // with white text on a clear background.
+    SDL_Surface* atlas = NULL;
+    if ((atlasWidth > 0) && (atlasHeight > 0)) {
+        atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!atlas) { printf("Glyph atlas could not be created! SDL Error: %s\n", SDL_GetError()); }
+    }
+
+    for (int i = 0; i < numGlyphs; ++i) {
+        if (!glyphSurfaces[i]) { continue; }
+        if (atlas) { SDL_BlitSurface(glyphSurfaces[i], NULL, atlas, &m_GlyphRects[i]); }
+        SDL_FreeSurface(glyphSurfaces[i]);
+    }
+
+    if (atlas) {
+        m_pGlyphAtlas = SDL_CreateTextureFromSurface(gRenderer, atlas);
+        if (!m_pGlyphAtlas) { printf("Glyph atlas texture could not be created! SDL Error: %s\n", SDL_GetError()); }
+        else { SDL_SetTextureBlendMode(m_pGlyphAtlas, SDL_BLENDMODE_BLEND); }
+        SDL_FreeSurface(atlas);
+    }
 }
 
 void Graphics::drawText(const char* textToDraw, SDL_Rect messageRect, SDL_Color color) {
-    // Draws the given text in a box with the specified position and dimention
-
-    SDL_Surface* surfaceMessage = TTF_RenderText_Solid(sans, textToDraw, color); // TODO Make this print something other than m
-    if (!surfaceMessage) { printf("TTF_OpenFont: %s\n", TTF_GetError()); }
-    SDL_Texture* message = SDL_CreateTextureFromSurface(gRenderer, surfaceMessage);
-    if (!message) { printf("Error 2\n"); }
-    //SDL_Rect messageRect = {
-    //    topLeftXPix,
-    //    topLeftYPix,
-    //    boxWidth,
-    //    boxHeight
-    //    //(int)(centerX - (squareSize / 2.f)),
-    //    //(int)(centerY - (squareSize / 2.f)),
-    //    //(int)squareSize,
-    //    //(int)squareSize
-    //};
-    SDL_RenderCopy(gRenderer, message, NULL, &messageRect);
-    SDL_FreeSurface(surfaceMessage);
-    SDL_DestroyTexture(message);
+    // Draws the given text in a box with the specified position and dimention.
+    // As before, the text is stretched to fill the box.
+    if (!m_pGlyphAtlas) { return; }
+
+    // Work out how big the text is unscaled, so we know how much to stretch it.
+    int textWidth = 0;
+    int textHeight = 0;
+    for (const char* c = textToDraw; *c; ++c) {
+        if ((*c < FIRST_GLYPH) || (*c > LAST_GLYPH)) { continue; }
+        const SDL_Rect& glyph = m_GlyphRects[*c - FIRST_GLYPH];
+        textWidth += glyph.w;
+        textHeight = std::max(textHeight, glyph.h);
+    }
+    if ((textWidth <= 0) || (textHeight <= 0)) { return; }
+
+    SDL_SetTextureColorMod(m_pGlyphAtlas, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(m_pGlyphAtlas, color.a);
+
+    // Place each glyph from its unscaled position, so that rounding doesn't
+    // leave gaps between them.
+    int penX = 0;
+    for (const char* c = textToDraw; *c; ++c) {
+        if ((*c < FIRST_GLYPH) || (*c > LAST_GLYPH)) { continue; }
+        const SDL_Rect& glyph = m_GlyphRects[*c - FIRST_GLYPH];
+
+        const int left = messageRect.x + ((penX * messageRect.w) / textWidth);
+        penX += glyph.w;
+        const int right = messageRect.x + ((penX * messageRect.w) / textWidth);
+
+        SDL_Rect destRect = {
+            left,
+            messageRect.y,
+            right - left,
+            (glyph.h * messageRect.h) / textHeight
+        };
+        SDL_RenderCopy(gRenderer, m_pGlyphAtlas, &glyph, &destRect);
+    }
 }
 
 void Graphics::drawGrid() {
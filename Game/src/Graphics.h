@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Entity.h"
+#include "RenderFrame.h"
 #include "SDL.h"
 #include "SDL_image.h"
 #include "SDL_ttf.h"
@@ -16,27 +16,53 @@ public:
 	Graphics();
 	virtual ~Graphics();  //SDL_DestroyRenderer(gRenderer);
 
-	void drawMob(Entity* m);
+	// Draws the mobs from a RenderFrame.
+	void drawMobs(const std::vector<RenderEntity>& mobs);
 	void drawText(const char* textToDraw, SDL_Rect messageRect, SDL_Color color);
-	void drawBuilding(Entity* b);
+	void drawBuilding(const RenderEntity& b);
 
+	// Starts a new frame, with the arena and UI panel drawn.
 	void resetFrame();
 
+	// Graphics needs to see SDL events that invalidate what it has cached
+	// (e.g. the window being resized, or the render targets being lost).
+	void handleEvent(const SDL_Event& e);
+
 	void drawElixir(float northElixir, float southElixir);
 	void drawWinScreen(int winningSide);
 
 	void render();
 
+	// Whether render() waits for the display's vertical sync.
+	bool isVSynced() const;
+
 private: 
 
 	void drawSquare(float centerX, float centerY, float size);
-	int healthToAlpha(const Entity* e);
+	int healthToAlpha(int health, int maxHealth);
 
 	void drawGrid();
 	void drawBG();
 	void drawUI();
 
+	// Renders every printable ASCII character into m_pGlyphAtlas, so that 
+	// drawText() can copy quads out of it rather than rasterizing text.  
+	// Replaces the atlas if there is one already.
+	void buildGlyphAtlas();
+
+	// Renders everything that doesn't change during a match (the background,
+	// river, bridges, grid and UI panel) into m_pArena.  Returns false if we
+	// can't render to a texture, in which case we draw it all every frame.
+	bool buildArena();
+
 	SDL_Renderer* gRenderer;
 	SDL_Window* gWindow;
 	TTF_Font* sans;
+
+	// The glyphs are rendered in white, and tinted with the text color when drawn.
+	static const int FIRST_GLYPH = ' ';
+	static const int LAST_GLYPH = '~';
+	SDL_Texture* m_pArena;		// NULL until built, or after it's invalidated
+	SDL_Texture* m_pGlyphAtlas;
+	SDL_Rect m_GlyphRects[LAST_GLYPH - FIRST_GLYPH + 1];	// where each glyph is in the atlas
 };
\ No newline at end of file
@@ -0,0 +1,184 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Log.h"
+
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+Log* Singleton<Log>::s_Obj = NULL;
+
+thread_local int Log::s_MuteDepth = 0;
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of 2");
+
+// How long the log thread sleeps when there's nothing to print.
+const std::chrono::milliseconds LOG_IDLE_SLEEP(2);
+
+Log::Log()
+    : m_pEntries(new Entry[LOG_BUFFER_SIZE])
+    , m_WritePos(0)
+    , m_ReadPos(0)
+    , m_NumDropped(0)
+    , m_bStop(false)
+{
+    // By default everything is printed, as it always has been.
+    for (int i = 0; i < numCategories; ++i)
+    {
+        m_Levels[i] = Debug;
+    }
+
+    // Each slot's sequence number says whose turn it is: when it equals the 
+    // write position, a writer can claim it, and when it's one more than that,
+    // the message in it is ready to print.
+    for (unsigned int i = 0; i < LOG_BUFFER_SIZE; ++i)
+    {
+        m_pEntries[i].m_Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_Thread = std::thread(&Log::threadMain, this);
+}
+
+Log::~Log()
+{
+    m_bStop = true;
+    m_Thread.join();
+
+    delete[] m_pEntries;
+}
+
+void Log::shutdown()
+{
+    if (exists())
+    {
+        delete &get();
+    }
+}
+
+void Log::write(Category category, Level level, const char* format, ...)
+{
+    // Claim a slot.  This is a compare-and-swap loop rather than a lock, so 
+    // several threads can write at once.
+    unsigned int pos = m_WritePos.load(std::memory_order_relaxed);
+    Entry* pEntry;
+    for (;;)
+    {
+        pEntry = &m_pEntries[pos & (LOG_BUFFER_SIZE - 1)];
+        const unsigned int seq = pEntry->m_Sequence.load(std::memory_order_acquire);
+        const int diff = (int)(seq - pos);
+        if (diff == 0)
+        {
+            if (m_WritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The buffer is full.  Never block the caller - just drop it.
+            m_NumDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = m_WritePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    pEntry->m_Category = category;
+    pEntry->m_Level = level;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(pEntry->m_Text, LOG_MAX_MESSAGE_LENGTH, format, args);
+    va_end(args);
+
+    // Hand it to the log thread.
+    pEntry->m_Sequence.store(pos + 1, std::memory_order_release);
+}
+
+void Log::flush()
+{
+    const unsigned int target = m_WritePos.load(std::memory_order_acquire);
+    while ((int)(m_ReadPos.load(std::memory_order_acquire) - target) < 0)
+    {
+        std::this_thread::yield();
+    }
+    fflush(stdout);
+}
+
+void Log::threadMain()
+{
+    bool bNeedsFlush = false;
+    while (!m_bStop)
+    {
+        if (drain() > 0)
+        {
+            bNeedsFlush = true;
+        }
+        else
+        {
+            // We've caught up, so push out what we printed and have a rest.
+            if (bNeedsFlush)
+            {
+                fflush(stdout);
+                bNeedsFlush = false;
+            }
+            std::this_thread::sleep_for(LOG_IDLE_SLEEP);
+        }
+    }
+
+    // Print whatever is left.
+    drain();
+    fflush(stdout);
+}
+
+unsigned int Log::drain()
+{
+    unsigned int numPrinted = 0;
+    unsigned int pos = m_ReadPos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Entry& entry = m_pEntries[pos & (LOG_BUFFER_SIZE - 1)];
+        if (entry.m_Sequence.load(std::memory_order_acquire) != pos + 1)
+        {
+            break;
+        }
+
+        fputs(entry.m_Text, stdout);
+
+        // Free the slot for the writer that will wrap around to it.
+        entry.m_Sequence.store(pos + LOG_BUFFER_SIZE, std::memory_order_release);
+        ++pos;
+        ++numPrinted;
+        m_ReadPos.store(pos, std::memory_order_release);
+    }
+
+    const unsigned int numDropped = m_NumDropped.exchange(0, std::memory_order_relaxed);
+    if (numDropped > 0)
+    {
+        fprintf(stderr, "Log buffer full - dropped %u messages\n", numDropped);
+    }
+
+    return numPrinted;
+}
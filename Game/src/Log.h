@@ -0,0 +1,148 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Singleton.h"
+#include <atomic>
+#include <thread>
+
+// Asynchronous, level-filtered logging.  LOG() formats the message straight
+// into a slot in a lock-free ring buffer and returns; a background thread 
+// drains the buffer and does the (slow) console I/O, so the simulation never
+// waits on stdout.  If the buffer fills up, new messages are dropped (and 
+// counted) rather than blocking the caller.
+//
+// Each category has its own runtime level (see setLevel()).  On top of that,
+// categories can be compiled out completely by defining 
+// LOG_COMPILED_CATEGORIES to a bitmask of the categories to keep - e.g. 
+// LOG_COMPILED_CATEGORIES=0 removes every LOG() call, arguments and all.
+//
+// Usage:  LOG(Combat, Info, "%s attacks %s", attackerName, targetName);
+//
+// NOTE: messages are truncated to LOG_MAX_MESSAGE_LENGTH characters.
+//
+// NOTE: Log::get() makes the log the first time it's called, which isn't 
+// thread safe, so call it once before starting any threads that log.  LOG() 
+// checks isMuted() first, so muted threads (e.g. sandboxes) never call it.
+
+#ifndef LOG_COMPILED_CATEGORIES
+#define LOG_COMPILED_CATEGORIES 0xFFFFFFFFu
+#endif
+
+#define LOG_IS_COMPILED(category) ((((unsigned int)(LOG_COMPILED_CATEGORIES)) >> Log::category) & 1u)
+
+#define LOG(category, level, ...)                                                   \
+    do                                                                              \
+    {                                                                               \
+        if (LOG_IS_COMPILED(category) && !Log::isMuted() &&                         \
+            Log::get().isEnabled(Log::category, Log::level))                        \
+        {                                                                           \
+            Log::get().write(Log::category, Log::level, __VA_ARGS__);               \
+        }                                                                           \
+    } while (0)
+
+const unsigned int LOG_BUFFER_SIZE = 4096;      // Must be a power of 2
+const unsigned int LOG_MAX_MESSAGE_LENGTH = 240;
+
+class Log : public Singleton<Log>
+{
+public:
+    enum Category
+    {
+        Combat,         // attacks and damage
+        Movement,       // mob movement and hiding
+        Placement,      // mob placement (mostly failures)
+        System,         // the game loop, timing, etc.
+
+        numCategories
+    };
+
+    enum Level
+    {
+        Debug,
+        Info,
+        Warning,
+        Error,
+
+        Off             // for setLevel(), to disable a category
+    };
+
+    Log();
+    virtual ~Log();
+
+    // Messages below this level are discarded, without being formatted.
+    void setLevel(Category category, Level level) { m_Levels[category] = level; }
+    Level getLevel(Category category) const { return m_Levels[category]; }
+
+    bool isEnabled(Category category, Level level) const { return (level >= m_Levels[category]) && (s_MuteDepth == 0); }
+
+    // Silences LOG() on the calling thread for as long as it's in scope - 
+    // e.g. while a Sandbox plays out a lookahead.  These nest.
+    class ScopedMute
+    {
+    public:
+        ScopedMute() { ++s_MuteDepth; }
+        ~ScopedMute() { --s_MuteDepth; }
+    };
+
+    // Whether the calling thread is muted.
+    static bool isMuted() { return s_MuteDepth > 0; }
+
+    // Queues a printf-style message for the background thread.  Use LOG() 
+    // rather than calling this directly.
+    void write(Category category, Level level, const char* format, ...);
+
+    // Waits until everything written so far has been printed.
+    void flush();
+
+    // Stops the background thread (printing anything still queued) and 
+    // destroys the log.  Call this before exiting.
+    static void shutdown();
+
+private:
+    struct Entry
+    {
+        std::atomic<unsigned int> m_Sequence;
+        Category m_Category;
+        Level m_Level;
+        char m_Text[LOG_MAX_MESSAGE_LENGTH];
+    };
+
+    void threadMain();
+
+    // Prints (and frees) the messages that are ready.  Returns how many there were.
+    unsigned int drain();
+
+private:
+    static thread_local int s_MuteDepth;
+
+    Level m_Levels[numCategories];
+
+    Entry* m_pEntries;                      // LOG_BUFFER_SIZE of them
+    std::atomic<unsigned int> m_WritePos;   // claimed by the writers
+    std::atomic<unsigned int> m_ReadPos;    // only advanced by the log thread
+    std::atomic<unsigned int> m_NumDropped;
+
+    std::atomic<bool> m_bStop;
+    std::thread m_Thread;
+};
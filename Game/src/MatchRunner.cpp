@@ -0,0 +1,116 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MatchRunner.h"
+
+#include "Game.h"
+#include "Log.h"
+#include "Replay.h"
+#include "StateHash.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+MatchRunner::MatchRunner(unsigned int numThreads)
+    : m_NumThreads(numThreads)
+{
+    if (m_NumThreads == 0)
+    {
+        // NOTE: hardware_concurrency() is allowed to return 0 if it doesn't know.
+        m_NumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+}
+
+std::vector<MatchResult> MatchRunner::run(unsigned int numMatches, int maxTicks, float tickSec,
+                                          const ControllerFactory& makeController) const
+{
+    std::vector<MatchResult> results(numMatches);
+
+    // Make sure the log exists before the workers start using it, since 
+    // Singleton::get() isn't thread safe.
+    Log::get();
+
+    // Each worker takes the next unplayed match until there aren't any left,
+    // so a long match on one thread doesn't hold up the others.
+    std::atomic<unsigned int> nextMatch(0);
+    auto worker = [&]()
+    {
+        for (unsigned int match = nextMatch++; match < numMatches; match = nextMatch++)
+        {
+            Game game(makeController(true), makeController(false));
+
+            const bool bRecord = !m_ReplayPrefix.empty();
+            ReplayRecorder recorder;
+            StateHashLog hashes;
+            if (bRecord)
+            {
+                game.setRecorder(&recorder);
+            }
+
+            MatchResult& result = results[match];
+            while ((result.m_Winner == 0) && (result.m_NumTicks < maxTicks))
+            {
+                game.tick(tickSec);
+                result.m_NumAllocations += game.getLastTickAllocations();
+                if (bRecord)
+                {
+                    hashes.add(game.getStateHash());
+                }
+                result.m_Winner = game.checkGameOver();
+                ++result.m_NumTicks;
+            }
+
+            if (bRecord)
+            {
+                const std::string path = m_ReplayPrefix + std::to_string(match + 1);
+                if (!recorder.save(path + ".replay"))
+                {
+                    LOG(System, Error, "Couldn't write replay %s.replay\n", path.c_str());
+                }
+                if (!hashes.save(path + ".hashes"))
+                {
+                    LOG(System, Error, "Couldn't write hash log %s.hashes\n", path.c_str());
+                }
+            }
+        }
+    };
+
+    const unsigned int numThreads = std::min(m_NumThreads, std::max(numMatches, 1u));
+    if (numThreads <= 1)
+    {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (unsigned int i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return results;
+}
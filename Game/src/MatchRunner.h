@@ -0,0 +1,69 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class iController;
+
+// The outcome of one match.
+struct MatchResult
+{
+    MatchResult() : m_Winner(0), m_NumTicks(0), m_NumAllocations(0) {}
+
+    int m_Winner;       // as Game::checkGameOver(): > 0 North, < 0 South, 0 nobody
+    int m_NumTicks;
+    long long m_NumAllocations;     // made by the ticks, see Game::getLastTickAllocations()
+};
+
+// Plays a batch of independent matches on a pool of worker threads, ticking
+// each one at a fixed dt as fast as it will go.  Every match has its own Game
+// (and controllers), so they share nothing but the read-only stats tables and
+// the log.
+class MatchRunner
+{
+public:
+    // Makes the controller for one side of a match.  The game takes ownership
+    // of it.  NOTE: this is called from the worker threads.
+    typedef std::function<iController*(bool bNorth)> ControllerFactory;
+
+    // If numThreads is 0, we use one per core.
+    explicit MatchRunner(unsigned int numThreads = 0);
+
+    unsigned int getNumThreads() const { return m_NumThreads; }
+
+    // If set, match i (counting from 1) is recorded to "<prefix><i>.replay",
+    // and its state hashes are saved to "<prefix><i>.hashes" (see StateHash).
+    void setReplayPrefix(const std::string& prefix) { m_ReplayPrefix = prefix; }
+
+    // Plays numMatches matches, each until somebody wins or it has run for 
+    // maxTicks ticks, and returns their results (in match order).
+    std::vector<MatchResult> run(unsigned int numMatches, int maxTicks, float tickSec,
+                                 const ControllerFactory& makeController) const;
+
+private:
+    unsigned int m_NumThreads;
+    std::string m_ReplayPrefix;         // empty => don't record
+};
@@ -23,33 +23,27 @@
 #include "Mob.h"
 
 #include "Constants.h"
+#include "FlowField.h"
+#include "FrameArena.h"
 #include "Game.h"
+#include "Log.h"
+#include "StateHash.h"
 
 
 #include <algorithm>
 #include <vector>
 
 
-Mob::Mob(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-    : Entity(stats, pos, isNorth)
-    , m_pWaypoint(NULL)
+Mob::Mob(Game& game, EntityStore& store, const EntityHandle& handle, const iEntityStats& stats, const Vec2& pos, bool isNorth)
+    : Entity(game, store, handle, stats, pos, isNorth)
 {
     assert(dynamic_cast<const iEntityStats_Mob*>(&stats) != NULL);
 }
 
-void Mob::tick(float deltaTSec)
+void Mob::decide(float deltaTSec)
 {
-    if (isHiding())
-    {
-        m_ticksSinceHidden++;
-    }
-    else 
-    {
-        m_ticksSinceHidden = 0;
-    }
-
-    // Tick the entity first.  This will pick our target, and attack it if it's in range.
-    Entity::tick(deltaTSec);
+    // Decide as an entity first.  This will pick our target, and attack it if it's in range.
+    Entity::decide(deltaTSec);
 
     // if our target isn't in range, move towards it.
     if (!targetInRange())
@@ -93,28 +87,28 @@ bool Mob::lineSquareIntersection(Vec2 start, float size, Vec2 obj_pos) const
 
     // check intersection with top side
     Vec2 intersection;
-    if (lineLineIntersect(start, m_Pos, topLeft, topRight, intersection)) {
+    if (lineLineIntersect(start, pos(), topLeft, topRight, intersection)) {
         if (intersection.x >= topLeft.x && intersection.x <= topRight.x) {
             return true;
         }
     }
 
     // check intersection with right side
-    if (lineLineIntersect(start, m_Pos, topRight, bottomRight, intersection)) {
+    if (lineLineIntersect(start, pos(), topRight, bottomRight, intersection)) {
         if (intersection.y >= topRight.y && intersection.y <= bottomRight.y) {
             return true;
         }
     }
 
     // check intersection with bottom side
-    if (lineLineIntersect(start, m_Pos, bottomLeft, bottomRight, intersection)) {
+    if (lineLineIntersect(start, pos(), bottomLeft, bottomRight, intersection)) {
         if (intersection.x >= bottomLeft.x && intersection.x <= bottomRight.x) {
             return true;
         }
     }
 
     // check intersection with left side
-    if (lineLineIntersect(start, m_Pos, topLeft, bottomLeft, intersection)) {
+    if (lineLineIntersect(start, pos(), topLeft, bottomLeft, intersection)) {
         if (intersection.y >= topLeft.y && intersection.y <= bottomLeft.y) {
             return true;
         }
@@ -129,89 +123,91 @@ bool Mob::lineSquareIntersection(Vec2 start, float size, Vec2 obj_pos) const
 
 bool Mob::isObstructedByGiantOrTower(Entity* e, Player& friendlyPlayer) const
 {
-    // For each friendly building check if the vector between the entity and mob is 
-    // intersected by a building.
-    for (Entity* entity : friendlyPlayer.getBuildings())
+    // The friendly towers and Giants are packed up once per tick (in
+    // Player::updateOccluders()).
+    const Occluders& occluders = friendlyPlayer.getOccluders();
+
+#if LINE_OF_SIGHT_USE_TILES
+    // The coarse test walks the tiles instead.  It doesn't agree with the 
+    // exact tests, so there's nothing to check it against here (the 
+    // Benchmarks measure how often they differ).
+    return occluders.isSegmentBlocked_Tiles(e->getPosition(), pos());
+#else
+    // The towers are looked up in the precomputed tables (see 
+    // TowerVisibility.h), so only the Giants need the slab test.
+    // NOTE: the LineOfSightRandom benchmark checks the slab test against 
+    // lineSquareIntersection(), and LineOfSightTables checks the tables.
+    return friendlyPlayer.getTowerVisibility().isSegmentBlocked(e->getPosition(), pos()) ||
+           occluders.isSegmentBlocked_Dynamic(e->getPosition(), pos());
+#endif
+}
+
+bool Mob::canBeSeenBy(Entity* e, Player& friendlyPlayer) const
+{
+    assert(e->isNorth() != isNorth());
+    if (e->isDead())
     {
-        if(lineSquareIntersection(e->getPosition(), entity->getStats().getSize(), entity->getPosition()) && !entity->isDead())
-        {
-            return true;
-        }
+        return false;
     }
-    // For each friendly building check if the vector between the entity and mob is 
-    // intersected by a giant.   
-    for (Entity* entity : friendlyPlayer.getMobs())
+
+    // Are we within the entity's sight radius?
+    const float sightRadius = e->getStatsData().m_SightRadius;
+    if (pos().distSqr(e->getPosition()) > (sightRadius * sightRadius))
     {
-        if (entity->getStats().getMobType() == iEntityStats::MobType::Giant)
-        {
-            if(lineSquareIntersection(e->getPosition(), entity->getStats().getSize(), entity->getPosition()) && !entity->isDead())
-            {
-                return true;
-            }
-        }
+        return false;
     }
 
-    return false;
+    // Check if the mob is not obstructed by a giant or tower from the entity.
+    return !isObstructedByGiantOrTower(e, friendlyPlayer);
 }
 
-
 bool Mob::isHiding() const
 {
-    // Gets all the entities in the game.
-    Player& northPlayer = Game::get().getPlayer(true);
-    Player& southPlayer = Game::get().getPlayer(false);
-
-    std::vector<Entity*> gameEntities;
-
-    // Get all the mobs and buildings of each player, and insert them into the Entities Vector
-    gameEntities.insert(gameEntities.end(), northPlayer.getMobs().begin(), northPlayer.getMobs().end());
-    gameEntities.insert(gameEntities.end(), southPlayer.getMobs().begin(), southPlayer.getMobs().end());
-    gameEntities.insert(gameEntities.end(), northPlayer.getBuildings().begin(), northPlayer.getBuildings().end());
-    gameEntities.insert(gameEntities.end(), southPlayer.getBuildings().begin(), southPlayer.getBuildings().end());
+    // Only Rogues can hide.
+    if (m_Data.m_MobType != iEntityStats::MobType::Rogue)
+    {
+        return false;
+    }
 
+    Player& friendlyPlayer = m_Game.getPlayer(m_bNorth);
+    Player& opposingPlayer = m_Game.getPlayer(!m_bNorth);
 
-    // If the mob is a rogue.
-    if (getStats().getMobType() == iEntityStats::MobType::Rogue)
+    // We're hiding if none of the opposing entities can see us.
+    for (Entity* pEntity : opposingPlayer.getMobs())
     {
-        // for each entity in game entities.
-        for (Entity* entity : gameEntities)
+        if (canBeSeenBy(pEntity, friendlyPlayer))
         {
-            Vec2 direction = entity->getPosition() - m_Pos;
-            float distance = direction.length();
-
-            // If the entity is from the opposing player, its not dead and the mob is within the entity's sight radius.
-            if (m_bNorth != entity->isNorth() && !entity->isDead() && entity->getStats().getSightRadius() >= distance)
-            {
-                // Check if the mob is not obstructed by a giant or tower from the entity.
-                if (!isObstructedByGiantOrTower(entity, Game::get().getPlayer(m_bNorth)))
-                {
-                    return false;
-                }
-
-            }
+            return false;
+        }
+    }
 
+    for (Entity* pEntity : opposingPlayer.getBuildings())
+    {
+        if (canBeSeenBy(pEntity, friendlyPlayer))
+        {
+            return false;
         }
-        return true;
     }
 
-    return false;
+    return true;
 }
 
-bool Mob::isHidden() const
+void Mob::updateVisibility(float deltaTSec)
 {
-    // Project 2: This is where you should put the logic for checking if a Rogue is
-    // hidden or not.  It probably involves something related to calling Game::Get()
-    // to get the Game, then calling getPlayer() on the game to get each player, then
-    // going through all the entities on the players and... well, you can take it 
-    // from there.  Once you've implemented this function, you can use it elsewhere to
-    // change the Rogue's behavior, damage, etc.  It is also used in by the Graphics
-    // to change the way the character renders (Rogues on the South team will render
-    // as grayed our when hidden, ones on the North team won't render at all).
-
-    // A mob is hidden if it has been hiding for longer than 2 seconds. 
-    return isHiding() && m_ticksSinceHidden >= getStats().timeToHide() / 0.05f;
+    // Project 2: This is where we work out whether a Rogue is hidden.  It is
+    // done once per tick (from Game::tick()), and everything else - targeting,
+    // movement and the Graphics - just reads the cached flag via isHidden().
+    if (isHiding())
+    {
+        m_TimeHiding += deltaTSec;
+    }
+    else
+    {
+        m_TimeHiding = 0.f;
+    }
 
-    
+    // A mob is hidden if it has been hiding for longer than timeToHide() seconds. 
+    setHidden((m_TimeHiding > 0.f) && (m_TimeHiding >= m_Data.m_TimeToHide));
 }
 
 
@@ -219,9 +215,9 @@ bool Mob::isHidden() const
 bool Mob::isEnemyInSpringAttackRange()
 {
     Vec2 destPos;
-    Player& opposingPlayer = Game::get().getPlayer(!m_bNorth);
+    Player& opposingPlayer = m_Game.getPlayer(!m_bNorth);
 
-    float springRange = getStats().getSpringRange();
+    float springRange = m_Data.m_SpringRange;
     float springRangeSq = springRange * springRange;
 
     // Checks whether the opposing player has a mob that is in
@@ -232,7 +228,7 @@ bool Mob::isEnemyInSpringAttackRange()
         if (!pEntity->isDead())
         {
 
-            float distSq = m_Pos.distSqr(pEntity->getPosition());
+            float distSq = pos().distSqr(pEntity->getPosition());
 
             if (distSq < springRangeSq)
             {
@@ -248,14 +244,17 @@ bool Mob::isEnemyInSpringAttackRange()
 Vec2 Mob::getHidingLocation(Entity* friendlyObject)
 {
     // Get the opposing player and sight range.
-    Player& opposingPlayer = Game::get().getPlayer(!m_bNorth);
-    float closestDist = getStats().getSightRadius() + 0.1f;
+    Player& opposingPlayer = m_Game.getPlayer(!m_bNorth);
+    float closestDist = m_Data.m_SightRadius + 0.1f;
     float closestDistSq = closestDist * closestDist;
 
-    // Get the game entities of the opposing player.
-    std::vector<Entity*> gameEntities;
-    std::vector<Entity*> opposingEntitiesInSight;
+    // Get the game entities of the opposing player.  These are only needed 
+    // for this call, so they come from the frame arena rather than the heap.
+    const FrameAllocator<Entity*> alloc(m_Game.getFrameArena());
+    FrameVector<Entity*> gameEntities(alloc);
+    FrameVector<Entity*> opposingEntitiesInSight(alloc);
 
+    gameEntities.reserve(opposingPlayer.getMobs().size() + opposingPlayer.getBuildings().size());
     gameEntities.insert(gameEntities.end(), opposingPlayer.getMobs().begin(), opposingPlayer.getMobs().end());
     gameEntities.insert(gameEntities.end(), opposingPlayer.getBuildings().begin(), opposingPlayer.getBuildings().end());
 
@@ -266,11 +265,11 @@ Vec2 Mob::getHidingLocation(Entity* friendlyObject)
         if (!pEntity->isDead())
         {
             // If the entity is within sight of the rogue
-            float distSq = m_Pos.distSqr(pEntity->getPosition());
+            float distSq = pos().distSqr(pEntity->getPosition());
             if (distSq < closestDistSq)
             {
                 // If the rogue would be seen by the entity
-                float enemySightSq = (pEntity->getStats().getSightRadius() + 0.1f) * (pEntity->getStats().getSightRadius() + 0.1f);
+                float enemySightSq = (pEntity->getStatsData().m_SightRadius + 0.1f) * (pEntity->getStatsData().m_SightRadius + 0.1f);
                 if (distSq <= enemySightSq)
                 {
                     // Add the entity to those that the rogue is hiding from
@@ -289,9 +288,9 @@ Vec2 Mob::getHidingLocation(Entity* friendlyObject)
     {
         // Approach the entity the rogue is hiding behind at the vector between the rogue and entity.
         // Within the hiding distance.
-        Vec2 testVec =  m_Pos - friendlyObject->getPosition();
+        Vec2 testVec =  pos() - friendlyObject->getPosition();
         testVec.normalize();
-        destPos += testVec * ((friendlyObject->getStats().getSize() / 1.6f) + getStats().getHideDistance());
+        destPos += testVec * ((friendlyObject->getStatsData().m_Size / 1.6f) + m_Data.m_HideDistance);
         
 
     }
@@ -301,11 +300,11 @@ Vec2 Mob::getHidingLocation(Entity* friendlyObject)
         // Hide behind the friendly entity.
         if (m_bNorth)
         {
-            destPos.y -= (friendlyObject->getStats().getSize() / 2.f) + getStats().getHideDistance();
+            destPos.y -= (friendlyObject->getStatsData().m_Size / 2.f) + m_Data.m_HideDistance;
         }
         else
         {
-            destPos.y += (friendlyObject->getStats().getSize() / 2.f) + getStats().getHideDistance();
+            destPos.y += (friendlyObject->getStatsData().m_Size / 2.f) + m_Data.m_HideDistance;
         }
     }
     // Otherwise
@@ -327,12 +326,12 @@ Vec2 Mob::getHidingLocation(Entity* friendlyObject)
         // Hide behind buildings at further distances to not hide in the building
         if (m_bFollowingBuilding)
         {
-            avgHidingVector = avgHidingVector * ((friendlyObject->getStats().getSize() / 1.6f) + getStats().getHideDistance());
+            avgHidingVector = avgHidingVector * ((friendlyObject->getStatsData().m_Size / 1.6f) + m_Data.m_HideDistance);
 
         } 
         else
         {
-            avgHidingVector = avgHidingVector * ((friendlyObject->getStats().getSize() / 2.f) + getStats().getHideDistance());
+            avgHidingVector = avgHidingVector * ((friendlyObject->getStatsData().m_Size / 2.f) + m_Data.m_HideDistance);
 
         }
 
@@ -345,8 +344,8 @@ Vec2 Mob::getHidingLocation(Entity* friendlyObject)
 
 bool Mob::friendlyGiantPreferRange()
 {
-    Player& friendlyPlayer = Game::get().getPlayer(m_bNorth);
-    float closestDist = getStats().perferGiantRange();
+    Player& friendlyPlayer = m_Game.getPlayer(m_bNorth);
+    float closestDist = m_Data.m_PreferGiantRange;
     float closestDistSq = closestDist * closestDist;
 
     // For each giant check if it is within the prefer giant range.
@@ -355,16 +354,15 @@ bool Mob::friendlyGiantPreferRange()
         assert(pEntity->isNorth() == isNorth());
         if (!pEntity->isDead())
         {
-            if (pEntity->getStats().getMobType() == iEntityStats::MobType::Giant)
+            if (pEntity->getStatsData().m_MobType == iEntityStats::MobType::Giant)
             {
-                float distSq = m_Pos.distSqr(pEntity->getPosition());
+                float distSq = pos().distSqr(pEntity->getPosition());
                 if (distSq < closestDistSq)
                 {
                     // If it is, set the giant to the target, and sent the flags.
                     closestDistSq = distSq;
-                    m_pTarget = pEntity;
-                    m_eFriendlyGiant = pEntity;
-                    m_pWaypoint = NULL;
+                    setTarget(pEntity);
+                    m_eFriendlyGiant = pEntity->getHandle();
                     m_bFollowingGiant = true;
                     return true;
 
@@ -390,12 +388,13 @@ void Mob::move(float deltaTSec)
     // If we have a target and it's on the same side of the river, we move towards it.
     //  Otherwise, we move toward the bridge.
     Vec2 destPos;
-    Player& friendlyPlayer = Game::get().getPlayer(m_bNorth);
+    Player& friendlyPlayer = m_Game.getPlayer(m_bNorth);
     bool bMoveToTarget = false;
     bool hasTarget = false;
+    bool bFollowingFlow = false;
 
 
-    float closestDist = getStats().getSightRadius();
+    float closestDist = m_Data.m_SightRadius;
     float closestDistSq = closestDist * closestDist;
 
     // If the mob is not hidden
@@ -406,10 +405,10 @@ void Mob::move(float deltaTSec)
         m_bFollowingGiant = false;
         m_bFollowingBuilding = false;
 
-        if (!!m_pTarget)
+        if (!!target())
         {
-            bool imTop = m_Pos.y < (GAME_GRID_HEIGHT / 2);
-            bool otherTop = m_pTarget->getPosition().y < (GAME_GRID_HEIGHT / 2);
+            bool imTop = pos().y < (GAME_GRID_HEIGHT / 2);
+            bool otherTop = target()->getPosition().y < (GAME_GRID_HEIGHT / 2);
 
             if (imTop == otherTop)
             {
@@ -420,12 +419,11 @@ void Mob::move(float deltaTSec)
         
         if (bMoveToTarget)
         {
-            m_pWaypoint = NULL;
-            destPos = m_pTarget->getPosition();
+            destPos = target()->getPosition();
             hasTarget = true;
         }
         // If the mob type is a Rogue.
-        else if (getStats().getMobType() == iEntityStats::MobType::Rogue)
+        else if (m_Data.m_MobType == iEntityStats::MobType::Rogue)
         {
             // Find the closest friendly Giant.
             for (Entity* pEntity : friendlyPlayer.getMobs())
@@ -433,17 +431,16 @@ void Mob::move(float deltaTSec)
                 assert(pEntity->isNorth() == isNorth());
                 if (!pEntity->isDead())
                 {
-                    if (pEntity->getStats().getMobType() == iEntityStats::MobType::Giant)
+                    if (pEntity->getStatsData().m_MobType == iEntityStats::MobType::Giant)
                     {
-                        float distSq = m_Pos.distSqr(pEntity->getPosition());
+                        float distSq = pos().distSqr(pEntity->getPosition());
                         if (distSq < closestDistSq)
                         {
                             closestDistSq = distSq;
                             destPos = pEntity->getPosition();
-                            m_pTarget = pEntity;
-                            m_eFriendlyGiant = pEntity;
+                            setTarget(pEntity);
+                            m_eFriendlyGiant = pEntity->getHandle();
                             hasTarget = true;
-                            m_pWaypoint = NULL;
                             m_bFollowingGiant = true;
 
                             /*destPos = getHidingLocation(pEntity);*/
@@ -454,7 +451,7 @@ void Mob::move(float deltaTSec)
             // Follow the closest Giant.
             if (m_bFollowingGiant)
             {
-                destPos = getHidingLocation(m_eFriendlyGiant);
+                destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyGiant));
             }
             // If the Rogue hasn't found a target yet
             if (!hasTarget)
@@ -466,19 +463,18 @@ void Mob::move(float deltaTSec)
                     assert(pEntity->isNorth() == isNorth());
                     if (!pEntity->isDead())
                     {
-                        if (pEntity->getStats().getType() == iEntityStats::Building)
+                        if (pEntity->getStatsData().m_Type == iEntityStats::Building)
                         {
                             
-                            float distSq = m_Pos.distSqr(pEntity->getPosition());
+                            float distSq = pos().distSqr(pEntity->getPosition());
                             
                             if (distSq < closestDistSq)
                             {
                                 closestDistSq = distSq;
                                 destPos = pEntity->getPosition();
-                                m_pTarget = pEntity;
-                                m_eFriendlyBuilding = pEntity;
+                                setTarget(pEntity);
+                                m_eFriendlyBuilding = pEntity->getHandle();
                                 hasTarget = true;
-                                m_pWaypoint = NULL;
                                 m_bFollowingBuilding = true;
                                 
                                 
@@ -489,41 +485,49 @@ void Mob::move(float deltaTSec)
                 // Follow the closest building found.
                 if (m_bFollowingBuilding)
                 {
-                    destPos = getHidingLocation(m_eFriendlyBuilding);
+                    destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyBuilding));
                 }
             }
 
         }
-        // If no target has been found, choose a waypoint.
+        // If no target has been found, follow the flow field toward the 
+        // enemy King.
         if (!hasTarget)
         {
-            if (!m_pWaypoint)
-            {
-                m_pWaypoint = pickWaypoint();
-            }
-            destPos = m_pWaypoint ? *m_pWaypoint : m_Pos;
-
-
+            bFollowingFlow = true;
+            destPos = FlowField::get(m_bNorth).getNextPoint(pos());
         }
     }
     // The mob is hiding. 
     else
     {
+        // Stop following anything that has died and been freed since we 
+        // started following it.
+        if (m_bFollowingGiant && !m_Game.getEntity(m_eFriendlyGiant))
+        {
+            m_bFollowingGiant = false;
+        }
+        if (m_bFollowingBuilding && !m_Game.getEntity(m_eFriendlyBuilding))
+        {
+            m_bFollowingBuilding = false;
+        }
+
         // If the enemy is in Spring attack range,
         // set the Spring attack flag and attack the target.
-        if (isEnemyInSpringAttackRange())
+        // NOTE: the mob in range may be one we can't target (because it's 
+        // hiding too), in which case we may have no target to spring at.
+        if (!!target() && isEnemyInSpringAttackRange())
         {
-            printf("Spring attack!\n");
+            LOG(Movement, Debug, "Spring attack!\n");
             isInSpringAttackRange = true;
             bMoveToTarget = true;
-            m_pWaypoint = NULL;
-            destPos = m_pTarget->getPosition();
+            destPos = target()->getPosition();
         }
         // Else if the rogue is following a giant.
         else if (m_bFollowingGiant)
         {
             // Get the hiding place around the giant.
-            destPos = getHidingLocation(m_eFriendlyGiant);
+            destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyGiant));
 
         }
         // Else if the rogue is following a build.
@@ -533,10 +537,10 @@ void Mob::move(float deltaTSec)
             if (friendlyGiantPreferRange())
             {
                 // Follow the giant.
-                destPos = getHidingLocation(m_eFriendlyGiant);
+                destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyGiant));
             }
             // Hide behind the building.
-            destPos = getHidingLocation(m_eFriendlyBuilding);
+            destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyBuilding));
         }
         else
         {
@@ -546,17 +550,16 @@ void Mob::move(float deltaTSec)
                 assert(pEntity->isNorth() == isNorth());
                 if (!pEntity->isDead())
                 {
-                    if (pEntity->getStats().getMobType() == iEntityStats::MobType::Giant)
+                    if (pEntity->getStatsData().m_MobType == iEntityStats::MobType::Giant)
                     {
-                        float distSq = m_Pos.distSqr(pEntity->getPosition());
+                        float distSq = pos().distSqr(pEntity->getPosition());
                         if (distSq < closestDistSq)
                         {
                             closestDistSq = distSq;
                             destPos = pEntity->getPosition();
-                            m_pTarget = pEntity;
-                            m_eFriendlyGiant = pEntity;
+                            setTarget(pEntity);
+                            m_eFriendlyGiant = pEntity->getHandle();
                             hasTarget = true;
-                            m_pWaypoint = NULL;
                             m_bFollowingGiant = true;
                         }
                     }
@@ -565,7 +568,7 @@ void Mob::move(float deltaTSec)
             // If the mob finds the closest giant, follow it.
             if (m_bFollowingGiant)
             {
-                destPos = getHidingLocation(m_eFriendlyGiant);
+                destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyGiant));
             }
 
             // If the mob doesn't find the giant, find the closest building.
@@ -576,17 +579,16 @@ void Mob::move(float deltaTSec)
                     assert(pEntity->isNorth() == isNorth());
                     if (!pEntity->isDead())
                     {
-                        if (pEntity->getStats().getType() == iEntityStats::Building)
+                        if (pEntity->getStatsData().m_Type == iEntityStats::Building)
                         {
-                            float distSq = m_Pos.distSqr(pEntity->getPosition());
+                            float distSq = pos().distSqr(pEntity->getPosition());
                             if (distSq < closestDistSq)
                             {
                                 closestDistSq = distSq;
                                 destPos = pEntity->getPosition();
-                                m_pTarget = pEntity;
-                                m_eFriendlyBuilding = pEntity;
+                                setTarget(pEntity);
+                                m_eFriendlyBuilding = pEntity->getHandle();
                                 hasTarget = true;
-                                m_pWaypoint = NULL;
                                 m_bFollowingBuilding = true;
                                 
                                 
@@ -598,7 +600,7 @@ void Mob::move(float deltaTSec)
                 // hide behind the building.
                 if (m_bFollowingBuilding)
                 {
-                    destPos = getHidingLocation(m_eFriendlyBuilding);
+                    destPos = getHidingLocation(m_Game.getEntity(m_eFriendlyBuilding));
                 }
             }
 
@@ -611,118 +613,181 @@ void Mob::move(float deltaTSec)
 
 
     // Actually do the moving
-    Vec2 moveVec = destPos - m_Pos;
+    Vec2 moveVec = destPos - pos();
     float distRemaining = moveVec.normalize();
     float moveDist;
     if (isInSpringAttackRange)
     {
-        moveDist = m_Stats.getSpringSpeed() * deltaTSec;
+        moveDist = m_Data.m_SpringSpeed * deltaTSec;
         
     }
     else
     {
-        moveDist = m_Stats.getSpeed() * deltaTSec;
+        moveDist = m_Data.m_Speed * deltaTSec;
     }
     
 
-    // if we're moving to m_pTarget, don't move into it
+    // if we're moving to target(), don't move into it
     if (bMoveToTarget)
     {
-        assert(m_pTarget);
-        distRemaining -= (m_Stats.getSize() + m_pTarget->getStats().getSize()) / 2.f;
+        assert(target());
+        distRemaining -= (m_Data.m_Size + target()->getStatsData().m_Size) / 2.f;
         distRemaining = std::max(0.f, distRemaining);
     }
 
+    // NOTE: we only decide where to go here.  We actually get there in 
+    // apply(), once everybody has decided.
+    Vec2 newPos = pos();
     if (moveDist <= distRemaining)
     {
-        m_Pos += moveVec * moveDist;
+        newPos += moveVec * moveDist;
     }
     else
     {
-        m_Pos += moveVec * distRemaining;
+        newPos += moveVec * distRemaining;
 
-        // if the destination was a waypoint, find the next one and continue movement
-        if (m_pWaypoint)
+        // If we were following the flow field, carry on along it with the 
+        // movement we have left (but no further than the next tile).
+        if (bFollowingFlow)
         {
-            m_pWaypoint = pickWaypoint();
-            destPos = m_pWaypoint ? *m_pWaypoint : m_Pos;
-            moveVec = destPos - m_Pos;
-            moveVec.normalize();
-            m_Pos += moveVec * distRemaining;
+            const float distLeft = moveDist - distRemaining;
+            destPos = FlowField::get(m_bNorth).getNextPoint(newPos);
+            moveVec = destPos - newPos;
+            const float distToNext = moveVec.normalize();
+            newPos += moveVec * std::min(distLeft, distToNext);
         }
     }
+    nextPos() = newPos;
+
+    // NOTE: Collisions are resolved by Game::resolveCollisions(), once every
+    // mob has moved.
+}
 
-    // Project 1: This is where your collision code will be called from
-    Mob* otherMob = checkCollision();
-    if (otherMob) {
-        processCollision(otherMob, deltaTSec);
+
+// The largest size of any mob type, which bounds how far apart two mobs can be
+// and still overlap.
+static float computeMaxMobSize()
+{
+    float maxSize = 0.f;
+    for (int i = 0; i < iEntityStats::numMobTypes; ++i)
+    {
+        maxSize = std::max(maxSize, MOB_STATS[i].m_Size);
     }
+    return maxSize;
 }
 
+static float getMaxMobSize()
+{
+    // NOTE: a function-local static is initialized exactly once, even if 
+    // several games are ticking on different threads.
+    static const float s_MaxSize = computeMaxMobSize();
+    return s_MaxSize;
+}
 
-const Vec2* Mob::pickWaypoint()
+void Mob::checkCollision(std::vector<Mob*>& outMobs) const
 {
-    // Project 2:  You may need to make some adjustments here, so that Rogues will go
-    // back to a friendly tower when they have nothing to attack or hide behind, rather 
-    // than suicide-rushing the enemy tower (which they can't damage).
-    //   Again, special-case code in a base class function bad.  Encapsulation good.
+    outMobs.clear();
 
+    // Mobs are treated as circles whose diameter is their size.  The grids only
+    // hold mobs, so we only need to look at the cells within reach of the
+    // biggest one.
+    const float mySize = m_Data.m_Size;
+    const float searchRadius = (mySize + getMaxMobSize()) / 2.f;
 
-    float smallestDistSq = FLT_MAX;
-    const Vec2* pClosest = NULL;
+    const Vec2& myPos = pos();
 
-    for (const Vec2& pt : Game::get().getWaypoints())
+    for (int side = 0; side < 2; ++side)
     {
+        const bool bNorth = (side == 0);
+        const SpatialGrid& grid = m_Game.getMobGrid(bNorth);
+        const EntityStore& mobs = m_Game.getPlayer(bNorth).getMobStore();
+        const std::vector<Vec2>& positions = mobs.getPositions();
+        const std::vector<int>& healths = mobs.getHealths();
 
+        int minX, minY, maxX, maxY;
+        grid.getCellRange(myPos, searchRadius, minX, minY, maxX, maxY);
+
+        for (int y = minY; y <= maxY; ++y)
         {
-            // Filter out any waypoints that are behind (or barely in front of) us.
-            // NOTE: (0, 0) is the top left corner of the screen
-            // TODO: Giant Waypoint Bug that came with the code
-            float yOffset = pt.y - m_Pos.y;
-            if ((m_bNorth && (yOffset < 1.f)) ||
-                (!m_bNorth && (yOffset > -1.f)) ||
-                (pt.y > 25.5f) ||
-                (pt.y < 5.f))
+            for (int x = minX; x <= maxX; ++x)
             {
-                continue;
-            }
+                for (unsigned int i : grid.getCell(x, y))
+                {
+                    if ((healths[i] <= 0) || (mobs.getEntities()[i] == this))
+                    {
+                        continue;
+                    }
 
-            float distSq = m_Pos.distSqr(pt);
-            if (distSq < smallestDistSq) {
-                smallestDistSq = distSq;
-                pClosest = &pt;
+                    const float minDist = (mySize + mobs.getStatsData(i).m_Size) / 2.f;
+                    if (myPos.distSqr(positions[i]) < (minDist * minDist))
+                    {
+                        outMobs.push_back(static_cast<Mob*>(mobs.getEntities()[i]));
+                    }
+                }
             }
         }
+    }
+}
 
+void Mob::processCollision(Mob* otherMob)
+{
+    const float minDist = (m_Data.m_Size + otherMob->getStatsData().m_Size) / 2.f;
 
+    Vec2 pushDir = pos() - otherMob->pos();
+    const float dist = pushDir.normalize();
 
-
+    // An earlier collision this tick may already have pushed us apart.
+    if (dist >= minDist)
+    {
+        return;
     }
 
+    // If we're exactly on top of each other, pick a direction that only 
+    // depends on the ids, so the result is the same every time.
+    if (dist <= 0.f)
+    {
+        pushDir = Vec2((getId() < otherMob->getId()) ? -1.f : 1.f, 0.f);
+    }
 
+    // Split the overlap by mass - each mob moves by the fraction of the total
+    // mass that belongs to the *other* mob.
+    const float myMass = m_Data.m_Mass;
+    const float otherMass = otherMob->getStatsData().m_Mass;
+    const float overlap = minDist - dist;
 
-    return pClosest;
+    pos() += pushDir * (overlap * (otherMass / (myMass + otherMass)));
+    otherMob->pos() -= pushDir * (overlap * (myMass / (myMass + otherMass)));
 }
 
-// Project 1: 
-//  1) return a vector of mobs that we're colliding with
-//  2) handle collision with towers & river 
-Mob* Mob::checkCollision() 
+void Mob::saveState(EntitySnapshot& out) const
 {
-    //for (const Mob* pOtherMob : Game::get().getMobs())
-    //{
-    //    if (this == pOtherMob) 
-    //    {
-    //        continue;
-    //    }
-
-    //    // Project 1: YOUR CODE CHECKING FOR A COLLISION GOES HERE
-    //}
-    return NULL;
+    Entity::saveState(out);
+
+    out.m_TimeHiding = m_TimeHiding;
+    out.m_bFollowingGiant = m_bFollowingGiant;
+    out.m_bFollowingBuilding = m_bFollowingBuilding;
+    out.m_FriendlyGiant = m_Game.getEntity(m_eFriendlyGiant) ? m_eFriendlyGiant : EntityHandle();
+    out.m_FriendlyBuilding = m_Game.getEntity(m_eFriendlyBuilding) ? m_eFriendlyBuilding : EntityHandle();
 }
 
-void Mob::processCollision(Mob* otherMob, float deltaTSec) 
+void Mob::loadState(const EntitySnapshot& in)
 {
-    // Project 1: YOUR COLLISION HANDLING CODE GOES HERE
+    Entity::loadState(in);
+
+    m_TimeHiding = in.m_TimeHiding;
+    m_bFollowingGiant = in.m_bFollowingGiant;
+    m_bFollowingBuilding = in.m_bFollowingBuilding;
+    m_eFriendlyGiant = in.m_FriendlyGiant;
+    m_eFriendlyBuilding = in.m_FriendlyBuilding;
 }
 
+void Mob::hashState(StateHash& hash) const
+{
+    Entity::hashState(hash);
+
+    hash.add(m_TimeHiding);
+    hash.add(m_bFollowingGiant);
+    hash.add(m_bFollowingBuilding);
+    hash.add(m_Game.getEntity(m_eFriendlyGiant) ? m_eFriendlyGiant : EntityHandle());
+    hash.add(m_Game.getEntity(m_eFriendlyBuilding) ? m_eFriendlyBuilding : EntityHandle());
+}
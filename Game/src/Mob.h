@@ -24,30 +24,45 @@
 
 #include "Entity.h"
 #include "Player.h"
-
-struct Waypoint;
+#include <vector>
 
 class Mob : public Entity {
 
 public:
-    Mob(const iEntityStats& stats, const Vec2& pos, bool isNorth);
+    // NOTE: mobs are created (and freed) by the MobPool, which hands out the handle.
+    Mob(Game& game, EntityStore& store, const EntityHandle& handle, const iEntityStats& stats, const Vec2& pos, bool isNorth);
 
-    virtual void tick(float deltaTSec);
+    virtual void decide(float deltaTSec);
 
-    virtual bool isHidden() const;
-    
+    // Works out whether we're hidden, and caches it in the store for isHidden().
+    virtual void updateVisibility(float deltaTSec);
+
+    // Fills outMobs with the live mobs (from either player) that overlap this
+    // one.  This uses Game's mob grids, so it is only valid during Game::tick().
+    void checkCollision(std::vector<Mob*>& outMobs) const;
+
+    // Pushes this mob and otherMob apart so that they no longer overlap.  The
+    // lighter mob is pushed further.
+    void processCollision(Mob* otherMob);
+
+    virtual void saveState(EntitySnapshot& out) const;
+    virtual void loadState(const EntitySnapshot& in);
+    virtual void hashState(StateHash& hash) const;
 
 protected:
     void move(float deltaTSec);
-    const Vec2* pickWaypoint();
-    Mob* checkCollision();
-    void processCollision(Mob* otherMob, float deltaTSec);
     
     // This function checks whether a mob is currently hiding.
     // A mob is hiding if all the opposing entities can't see it.
     bool isHiding() const;
+
+    // Checks whether an opposing entity is alive, close enough to see us, and
+    // has a clear line of sight to us.
+    bool canBeSeenBy(Entity* e, Player& friendlyPlayer) const;
     
     // A function that checks with the mob is obstructed from the entity by a tower or Giant.
+    // NOTE: this uses the friendly player's occluders, which are only updated at the 
+    // start of each tick.  See LINE_OF_SIGHT_USE_TILES in Occluders.h for the coarse version.
     bool isObstructedByGiantOrTower(Entity* e, Player& friendlyPlayer) const;
 
     // Checks if a line intersects with a square.
@@ -64,23 +79,25 @@ protected:
     Vec2 getHidingLocation(Entity* friendlyObject);
 
 private:
-    const Vec2* m_pWaypoint;
-
-    // Counts amount of ticks since last hidden.
-    int m_ticksSinceHidden = 0;
+    // How long (in seconds) we've been hiding.  Updated once per tick by 
+    // updateVisibility().
+    float m_TimeHiding = 0.f;
 
     // Flag for if the mob is following a giant.
     bool m_bFollowingGiant = false;
 
     // The friendly giant the mob is following.
-    Entity* m_eFriendlyGiant;
+    EntityHandle m_eFriendlyGiant;
 
     // Flag for if the mob is following a building.
     bool m_bFollowingBuilding = false;
 
 
     // The friendly building the mob is following.
-    Entity* m_eFriendlyBuilding;
+    EntityHandle m_eFriendlyBuilding;
+
+    // The micro benchmarks time some of our protected methods on their own.
+    friend struct BenchmarkAccess;
 
     
 };
@@ -0,0 +1,119 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MobPool.h"
+
+#include "Mob.h"
+#include <algorithm>
+#include <assert.h>
+#include <new>
+
+MobPool::MobPool(bool bNorth, unsigned int capacity)
+    : m_bNorth(bNorth)
+    , m_Capacity(capacity)
+    , m_pSlots(static_cast<Mob*>(::operator new(sizeof(Mob) * capacity)))
+    , m_Generations(capacity, 0)
+    , m_InUse(capacity, 0)
+    , m_NumInUse(0)
+    , m_FirstFree(0)
+    , m_NextGeneration(0)
+{
+}
+
+MobPool::~MobPool()
+{
+    for (unsigned int i = 0; i < m_Capacity; ++i)
+    {
+        if (m_InUse[i])
+        {
+            m_pSlots[i].~Mob();
+        }
+    }
+
+    ::operator delete(m_pSlots);
+}
+
+Mob* MobPool::create(Game& game, EntityStore& store, const iEntityStats& stats, const Vec2& pos)
+{
+    if (m_NumInUse == m_Capacity)
+    {
+        return NULL;
+    }
+
+    // NOTE: mobs are only spawned a few at a time, so a scan is plenty.
+    unsigned int slot = m_FirstFree;
+    while (m_InUse[slot])
+    {
+        ++slot;
+    }
+    assert(slot < m_Capacity);
+    m_FirstFree = slot;
+
+    return createAt(slot, m_NextGeneration++, game, store, stats, pos);
+}
+
+void MobPool::free(Mob* pMob)
+{
+    assert(pMob);
+    const unsigned int slot = (unsigned int)(pMob - m_pSlots);
+    assert(slot < m_Capacity);
+    assert(m_InUse[slot]);
+    assert(pMob->getHandle().m_Generation == m_Generations[slot]);
+
+    pMob->~Mob();
+    m_InUse[slot] = 0;
+    --m_NumInUse;
+    m_FirstFree = std::min(m_FirstFree, slot);
+}
+
+Mob* MobPool::get(const EntityHandle& handle) const
+{
+    assert(!handle.m_bBuilding);
+    assert(handle.m_bNorth == m_bNorth);
+
+    if ((handle.m_Index >= m_Capacity) ||
+        !m_InUse[handle.m_Index] ||
+        (m_Generations[handle.m_Index] != handle.m_Generation))
+    {
+        return NULL;
+    }
+
+    return &m_pSlots[handle.m_Index];
+}
+
+Mob* MobPool::createAt(unsigned int slot, unsigned int generation, Game& game, EntityStore& store,
+                       const iEntityStats& stats, const Vec2& pos)
+{
+    assert(slot < m_Capacity);
+    assert(!m_InUse[slot]);
+
+    m_InUse[slot] = 1;
+    ++m_NumInUse;
+    m_Generations[slot] = generation;
+    if (slot == m_FirstFree)
+    {
+        ++m_FirstFree;
+    }
+
+    const EntityHandle handle(m_bNorth, false, slot, generation);
+    return new (&m_pSlots[slot]) Mob(game, store, handle, stats, pos, m_bNorth);
+}
@@ -0,0 +1,86 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "EntityStats.h"
+#include "Vec2.h"
+#include <vector>
+
+class EntityStore;
+class Game;
+class Mob;
+
+// A fixed-capacity pool of Mob objects.  All of the memory is allocated up 
+// front; spawning a mob constructs it in place in the lowest free slot, and 
+// freeing it destroys the mob and frees the slot.  So a long match never 
+// allocates (or leaks) mobs, however many of them come and go.
+//   Every mob gets a new generation (from a counter for the whole pool), so
+// that EntityHandles to the mob that had its slot before stop resolving.
+//   Which slot and generation the next mob gets depends only on which slots
+// are in use and on the counter, so restoring a snapshot (the live mobs and 
+// the counter) gets the same handles for new mobs as the original game.
+class MobPool
+{
+public:
+    MobPool(bool bNorth, unsigned int capacity);
+    ~MobPool();
+
+    unsigned int capacity() const { return m_Capacity; }
+    unsigned int numFree() const { return m_Capacity - m_NumInUse; }
+
+    // Constructs a mob in a free slot.  Returns NULL if the pool is full.
+    Mob* create(Game& game, EntityStore& store, const iEntityStats& stats, const Vec2& pos);
+
+    // Destroys the mob and frees its slot.  Any handles to it become stale.
+    void free(Mob* pMob);
+
+    // Returns the mob the handle refers to, or NULL if it has been freed.
+    Mob* get(const EntityHandle& handle) const;
+
+    // Constructs a mob in a specific free slot, with a specific generation.
+    // This is for restoring snapshots, where the mobs must go back in the 
+    // slots they came from so that the handles in the snapshot still resolve.
+    Mob* createAt(unsigned int slot, unsigned int generation, Game& game, EntityStore& store,
+                  const iEntityStats& stats, const Vec2& pos);
+
+    // The generation the next mob will get.  Snapshots save and restore this
+    // along with the mobs.
+    unsigned int getNextGeneration() const { return m_NextGeneration; }
+    void setNextGeneration(unsigned int generation) { m_NextGeneration = generation; }
+
+private:
+    MobPool(const MobPool&);
+    MobPool& operator=(const MobPool&);
+
+private:
+    bool m_bNorth;
+    unsigned int m_Capacity;
+
+    Mob* m_pSlots;                          // raw storage, m_Capacity mobs
+    std::vector<unsigned int> m_Generations;
+    std::vector<unsigned char> m_InUse;     // a bool, but without vector<bool>
+    unsigned int m_NumInUse;
+    unsigned int m_FirstFree;               // no slot below this is free
+    unsigned int m_NextGeneration;
+};
@@ -0,0 +1,175 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Occluders.h"
+
+#include <algorithm>
+
+#if OCCLUDERS_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+static const unsigned int ksLaneWidth = 4;
+
+// Padding boxes sit here, with no size.  Any segment on the field misses them.
+static const float ksFarAway = -1000000.f;
+
+// The slab test works with 1 / direction.  When a direction is (nearly) zero
+// we use a big number instead of infinity, so that we never multiply 0 by 
+// infinity and get a NaN.
+static float safeInverse(float d)
+{
+    const float ksHuge = 1e30f;
+    if (std::fabs(d) < 1e-12f)
+    {
+        return (d < 0.f) ? -ksHuge : ksHuge;
+    }
+    return 1.f / d;
+}
+
+Occluders::Occluders()
+    : m_NumBoxes(0)
+    , m_NextSlot(0)
+    , m_FirstDynamic(0)
+{
+}
+
+void Occluders::clear()
+{
+    m_MinX.clear();
+    m_MinY.clear();
+    m_MaxX.clear();
+    m_MaxY.clear();
+    m_NumBoxes = 0;
+    m_NextSlot = 0;
+    m_FirstDynamic = 0;
+    m_Tiles.clear();
+}
+
+void Occluders::addBox(const Vec2& center, float size)
+{
+    const float halfSize = size / 2.f;
+
+    // Overwrite the first padding box if there is one, otherwise start a new
+    // group of 4 (with the unused lanes as padding).
+    if (m_NextSlot == m_MinX.size())
+    {
+        m_MinX.resize(m_MinX.size() + ksLaneWidth, ksFarAway);
+        m_MinY.resize(m_MinY.size() + ksLaneWidth, ksFarAway);
+        m_MaxX.resize(m_MaxX.size() + ksLaneWidth, ksFarAway);
+        m_MaxY.resize(m_MaxY.size() + ksLaneWidth, ksFarAway);
+    }
+
+    m_MinX[m_NextSlot] = center.x - halfSize;
+    m_MinY[m_NextSlot] = center.y - halfSize;
+    m_MaxX[m_NextSlot] = center.x + halfSize;
+    m_MaxY[m_NextSlot] = center.y + halfSize;
+    ++m_NextSlot;
+    ++m_NumBoxes;
+
+    m_Tiles.addBox(center, size);
+}
+
+void Occluders::beginDynamic()
+{
+    // Leave the rest of the current group as padding.
+    m_NextSlot = m_MinX.size();
+    m_FirstDynamic = m_NextSlot;
+}
+
+bool Occluders::isSegmentBlockedFrom(const Vec2& start, const Vec2& end, size_t firstSlot) const
+{
+#if OCCLUDERS_USE_SSE
+    // Slab test: for each axis, find the range of t (along start->end) where 
+    // the segment is between the box's min and max.  The segment hits the box
+    // if the ranges for x and y overlap each other and [0, 1].
+    const __m128 startX = _mm_set1_ps(start.x);
+    const __m128 startY = _mm_set1_ps(start.y);
+    const __m128 invDirX = _mm_set1_ps(safeInverse(end.x - start.x));
+    const __m128 invDirY = _mm_set1_ps(safeInverse(end.y - start.y));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+
+    const size_t numPacked = m_MinX.size();
+    for (size_t i = firstSlot; i < numPacked; i += ksLaneWidth)
+    {
+        const __m128 tX1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&m_MinX[i]), startX), invDirX);
+        const __m128 tX2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&m_MaxX[i]), startX), invDirX);
+        const __m128 tY1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&m_MinY[i]), startY), invDirY);
+        const __m128 tY2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&m_MaxY[i]), startY), invDirY);
+
+        __m128 tNear = _mm_max_ps(_mm_min_ps(tX1, tX2), _mm_min_ps(tY1, tY2));
+        __m128 tFar = _mm_min_ps(_mm_max_ps(tX1, tX2), _mm_max_ps(tY1, tY2));
+        tNear = _mm_max_ps(tNear, zero);
+        tFar = _mm_min_ps(tFar, one);
+
+        if (_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)) != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+#else
+    return isSegmentBlocked_Scalar(start, end, firstSlot);
+#endif
+}
+
+bool Occluders::isSegmentBlocked_Scalar(const Vec2& start, const Vec2& end, size_t firstSlot) const
+{
+    const float invDirX = safeInverse(end.x - start.x);
+    const float invDirY = safeInverse(end.y - start.y);
+
+    // NOTE: there may be padding boxes in the middle, as well as at the end,
+    // but no segment on the field can hit them.
+    for (size_t i = firstSlot; i < m_MinX.size(); ++i)
+    {
+        const float tX1 = (m_MinX[i] - start.x) * invDirX;
+        const float tX2 = (m_MaxX[i] - start.x) * invDirX;
+        const float tY1 = (m_MinY[i] - start.y) * invDirY;
+        const float tY2 = (m_MaxY[i] - start.y) * invDirY;
+
+        const float tNear = std::max(std::max(std::min(tX1, tX2), std::min(tY1, tY2)), 0.f);
+        const float tFar = std::min(std::min(std::max(tX1, tX2), std::max(tY1, tY2)), 1.f);
+
+        if (tNear <= tFar)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Occluders::containsPoint(const Vec2& pt) const
+{
+    for (size_t i = 0; i < m_MinX.size(); ++i)
+    {
+        if ((pt.x >= m_MinX[i]) && (pt.x <= m_MaxX[i]) && 
+            (pt.y >= m_MinY[i]) && (pt.y <= m_MaxY[i]))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
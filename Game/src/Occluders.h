@@ -0,0 +1,98 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "OcclusionGrid.h"
+#include "Vec2.h"
+#include <vector>
+
+// Set to 0 to force the scalar version of the line of sight kernel.
+#if !defined(OCCLUDERS_USE_SSE)
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1)) || defined(__SSE__)
+#define OCCLUDERS_USE_SSE 1
+#else
+#define OCCLUDERS_USE_SSE 0
+#endif
+#endif
+
+// Set to 1 to have the Rogues' line of sight use the tile grid (see 
+// OcclusionGrid.h) rather than the exact test.  It's cheaper when there are
+// a lot of Giants, but coarser, so Rogues hide more readily.
+#ifndef LINE_OF_SIGHT_USE_TILES
+#define LINE_OF_SIGHT_USE_TILES 0
+#endif
+
+// A packed list of the square boxes that block line of sight (i.e. a player's
+// towers and Giants).  The boxes are stored as a structure of arrays, padded
+// out to a multiple of 4 with boxes that are far off the field, so that the 
+// SSE kernel can test 4 boxes at a time with no scalar tail.  The boxes are
+// also rasterized into a tile grid, for the cheaper (but coarser) test.
+//   The static boxes (the towers) are added first, and then the dynamic ones
+// (the Giants) after a call to beginDynamic(), so that the dynamic ones can be
+// tested on their own - see TowerVisibility.h.
+class Occluders
+{
+public:
+    Occluders();
+
+    void clear();
+    void addBox(const Vec2& center, float size);
+
+    // The boxes added from here on are dynamic.  Pads out the current group of
+    // 4, so that the dynamic boxes start a group of their own.
+    void beginDynamic();
+
+    unsigned int getNumBoxes() const { return m_NumBoxes; }
+
+    // Does the segment from start to end pass through (or touch) any box?
+    // Uses SSE when it's available, and the scalar version otherwise.
+    bool isSegmentBlocked(const Vec2& start, const Vec2& end) const { return isSegmentBlockedFrom(start, end, 0); }
+
+    // The same, but only against the dynamic boxes.
+    bool isSegmentBlocked_Dynamic(const Vec2& start, const Vec2& end) const { return isSegmentBlockedFrom(start, end, m_FirstDynamic); }
+
+    // The same slab test, one box at a time (from the given slot on).
+    bool isSegmentBlocked_Scalar(const Vec2& start, const Vec2& end, size_t firstSlot = 0) const;
+
+    // Does the segment pass through any tile that a box overlaps?  This 
+    // blocks everything the tests above block, and some near misses too.
+    bool isSegmentBlocked_Tiles(const Vec2& start, const Vec2& end) const { return m_Tiles.isSegmentBlocked(start, end); }
+
+    // Is the point inside (or on the edge of) any box?
+    bool containsPoint(const Vec2& pt) const;
+
+private:
+    // Tests the boxes from the given slot on (which must start a group of 4).
+    bool isSegmentBlockedFrom(const Vec2& start, const Vec2& end, size_t firstSlot) const;
+
+private:
+    std::vector<float> m_MinX;
+    std::vector<float> m_MinY;
+    std::vector<float> m_MaxX;
+    std::vector<float> m_MaxY;
+    unsigned int m_NumBoxes;
+    size_t m_NextSlot;              // the first padding box
+    size_t m_FirstDynamic;          // the slot of the first dynamic box
+
+    OcclusionGrid m_Tiles;
+};
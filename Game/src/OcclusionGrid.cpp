@@ -0,0 +1,108 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OcclusionGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+OcclusionGrid::OcclusionGrid()
+{
+    clear();
+}
+
+void OcclusionGrid::clear()
+{
+    memset(m_Bits, 0, sizeof(m_Bits));
+}
+
+void OcclusionGrid::addBox(const Vec2& center, float size)
+{
+    const float halfSize = size / 2.f;
+    const int minX = toTileX(center.x - halfSize);
+    const int minY = toTileY(center.y - halfSize);
+    const int maxX = toTileX(center.x + halfSize);
+    const int maxY = toTileY(center.y + halfSize);
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            const int i = toTileIndex(x, y);
+            m_Bits[i / 64] |= (1ull << (i % 64));
+        }
+    }
+}
+
+bool OcclusionGrid::isSegmentBlocked(const Vec2& start, const Vec2& end) const
+{
+    int x = toTileX(start.x);
+    int y = toTileY(start.y);
+    const int endX = toTileX(end.x);
+    const int endY = toTileY(end.y);
+
+    if (isTileBlocked(x, y))
+    {
+        return true;
+    }
+
+    // Amanatides & Woo: tMax is how far along the segment (as a fraction of 
+    // it) we cross the next tile edge on each axis, and tDelta is how far 
+    // apart those edges are.  We step on whichever axis crosses first.
+    const float dirX = end.x - start.x;
+    const float dirY = end.y - start.y;
+    const int stepX = (dirX < 0.f) ? -1 : 1;
+    const int stepY = (dirY < 0.f) ? -1 : 1;
+
+    const float ksHuge = 1e30f;
+    const float tDeltaX = (dirX != 0.f) ? std::fabs(1.f / dirX) : ksHuge;
+    const float tDeltaY = (dirY != 0.f) ? std::fabs(1.f / dirY) : ksHuge;
+    const float edgeX = (float)((stepX > 0) ? (x + 1) : x);
+    const float edgeY = (float)((stepY > 0) ? (y + 1) : y);
+    float tMaxX = (dirX != 0.f) ? ((edgeX - start.x) / dirX) : ksHuge;
+    float tMaxY = (dirY != 0.f) ? ((edgeY - start.y) / dirY) : ksHuge;
+
+    // The walk takes exactly one step per tile boundary between the two end 
+    // tiles, so count the steps rather than trusting the floating point to 
+    // land on the last tile.
+    for (int numSteps = std::abs(endX - x) + std::abs(endY - y); numSteps > 0; --numSteps)
+    {
+        if ((y == endY) || ((x != endX) && (tMaxX < tMaxY)))
+        {
+            x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            y += stepY;
+            tMaxY += tDeltaY;
+        }
+
+        if (isTileBlocked(x, y))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
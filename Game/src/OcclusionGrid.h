@@ -0,0 +1,59 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Constants.h"
+#include "Vec2.h"
+#include <stdint.h>
+
+// The tiles of the arena that a player's line of sight blockers (towers and 
+// Giants) cover, one bit per tile.  A box marks every tile it overlaps, even
+// a little, and a line of sight query walks the tiles under the segment, so
+// the cost of a query depends on how long the segment is rather than how 
+// many blockers there are.
+//   This is coarser than the exact test in Occluders: a segment that passes 
+// through the corner of a tile that a box only clips is blocked here, but not
+// there.  It never misses a box that the exact test would hit.
+class OcclusionGrid
+{
+public:
+    OcclusionGrid();
+
+    void clear();
+    void addBox(const Vec2& center, float size);
+
+    bool isTileBlocked(int x, int y) const
+    {
+        const int i = toTileIndex(x, y);
+        return (m_Bits[i / 64] & (1ull << (i % 64))) != 0;
+    }
+
+    // Does the segment from start to end pass through any blocked tile 
+    // (including the ones at either end)?  Walks the tiles with a DDA.
+    bool isSegmentBlocked(const Vec2& start, const Vec2& end) const;
+
+private:
+    static const int ksNumWords = ((GAME_GRID_WIDTH * GAME_GRID_HEIGHT) + 63) / 64;
+
+    uint64_t m_Bits[ksNumWords];
+};
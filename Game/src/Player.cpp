@@ -22,19 +22,32 @@
 
 #include "Player.h"
 
+#include "AllocationCounter.h"
 #include "Building.h"
 #include "Constants.h"
 #include "iController.h"
 #include "Game.h"
+#include "Log.h"
 #include "Mob.h"
-
-Player::Player(iController* pControl, bool bNorth)
-    : m_pControl(pControl)
+#include "Profiler.h"
+#include "Replay.h"
+#include "Sandbox.h"
+#include "StateHash.h"
+
+Player::Player(Game& game, iController* pControl, bool bNorth)
+    : m_Game(game)
+    , m_pControl(pControl)
     , m_bNorth(bNorth)
     , m_Elixir(capElixir(STARTING_ELIXIR))
+    , m_BuildingStore(true)
+    , m_MobStore(false)
+    , m_MobPool(bNorth, MAX_MOBS_PER_PLAYER)
 {
     buildBuildings();
 
+    // The pool caps the number of mobs, so the store never needs to grow.
+    m_MobStore.reserve(MAX_MOBS_PER_PLAYER);
+
     // for now, all mob types are available.
     for (size_t i = 0; i < iEntityStats::numMobTypes; ++i)
     {
@@ -48,36 +61,40 @@ Player::Player(iController* pControl, bool bNorth)
 Player::~Player()
 {
     delete m_pControl;      // it's safe to delete NULL
-    for (Entity* pBuilding : m_Buildings) delete pBuilding;
-    for (Entity* pMob : m_Mobs) delete pMob;
-    for (Entity* pMob : m_DeadMobs) delete pMob;
+    m_BuildingStore.deleteAll();
+    // NOTE: m_MobPool destroys the mobs
 }
 
 iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2& pos)
 {
-    // Adjust the position to be a tile center.  Tiles are 1 unit wide.
-    // TODO: move the code for converting to tile position somewhere shared
-    const int iTileX = (int)pos.x;
-    const int iTileY = (int)pos.y;
-    const float fTileX = (float)iTileX + 0.5f;
-    const float fTileY = (float)iTileY + 0.5f;
-    Vec2 tilePos(fTileX, fTileY);
-
-    // Validate the position
+    // Validate the position.  This has to happen before converting to a tile,
+    // since the conversion clamps positions off the field into the border 
+    // tiles.
     // TODO: move this functionality somewhere shared.
-    if ((tilePos.x <= 0) || (tilePos.x >= GAME_GRID_WIDTH))
+    if ((pos.x < 0.f) || (pos.x >= (float)GAME_GRID_WIDTH))
     {
-        std::cout << "Invalid Location (X): (" << tilePos.x << ", " <<
-            tilePos.y << ")\n";
+        LOG(Placement, Warning, "Invalid Location (X): (%g, %g)\n", pos.x, pos.y);
         return InvalidX;
     }
 
+    if ((pos.y < 0.f) || (pos.y >= (float)GAME_GRID_HEIGHT))
+    {
+        LOG(Placement, Warning, "Invalid Location (Y): (%g, %g)\n", pos.x, pos.y);
+        return InvalidY;
+    }
+
+    // Adjust the position to be a tile center.
+    const int iTileX = toTileX(pos.x);
+    const int iTileY = toTileY(pos.y);
+    const float fTileX = (float)iTileX + 0.5f;
+    const float fTileY = (float)iTileY + 0.5f;
+    Vec2 tilePos(fTileX, fTileY);
+
     if (m_bNorth)
     {
         if (tilePos.y >= RIVER_TOP_Y)
         {
-            std::cout << "Invalid Location (Y): (" << tilePos.x << ", " <<
-                tilePos.y << ")\n";
+            LOG(Placement, Warning, "Invalid Location (Y): (%g, %g)\n", tilePos.x, tilePos.y);
 
             return InvalidY;
         }
@@ -86,8 +103,7 @@ iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2
     {
         if (tilePos.y <= RIVER_BOT_Y)
         {
-            std::cout << "Invalid Location (Y): (" << tilePos.x << ", " <<
-                tilePos.y << ")\n";
+            LOG(Placement, Warning, "Invalid Location (Y): (%g, %g)\n", tilePos.x, tilePos.y);
 
             return InvalidY;
         }
@@ -98,8 +114,7 @@ iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2
     const float cost = stats.getElixirCost();
     if (cost > m_Elixir)
     {
-        std::cout << "Insufficient Elixir: " << cost << " > " << m_Elixir <<
-            std::endl;
+        LOG(Placement, Warning, "Insufficient Elixir: %g > %g\n", cost, m_Elixir);
 
         return InsufficientElixir;
     }
@@ -107,66 +122,132 @@ iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2
     // Make sure that the mob type is one that's currently available
     if (std::find(m_AvailableMobs.begin(), m_AvailableMobs.end(), type) == m_AvailableMobs.end())
     {
-        std::cout << "Mob type not available\n";
+        LOG(Placement, Warning, "Mob type not available\n");
 
         return MobTypeUnavailable;
     }
 
+    // Make sure that we have room for it
+    if (m_MobPool.numFree() == 0)
+    {
+        LOG(Placement, Warning, "Too many mobs: %u\n", m_MobPool.capacity());
+
+        return TooManyMobs;
+    }
+
     // Checks are done - make the mob.
     m_Elixir -= cost;
-    Mob* pMob = new Mob(stats, tilePos, m_bNorth);
-    m_Mobs.push_back(pMob);
+    // NOTE: the mob adds itself to the store
+    m_MobPool.create(m_Game, m_MobStore, stats, tilePos);
+
+    if (ReplayRecorder* pRecorder = m_Game.getRecorder())
+    {
+        pRecorder->recordPlacement(m_bNorth, type, iTileX, iTileY);
+    }
 
     return Success;
 }
 
 void Player::tick(float deltaTSec)
 {
-    m_Elixir += deltaTSec * ELIXIR_PER_SECOND;
-    m_Elixir = std::min(m_Elixir, 10.f);
+    PROFILE_SCOPE(m_bNorth ? "North Player::tick" : "South Player::tick");
+
+    {
+        PROFILE_SCOPE("Elixir");
+        m_Elixir += deltaTSec * ELIXIR_PER_SECOND;
+        m_Elixir = std::min(m_Elixir, 10.f);
+    }
 
     if (m_pControl)
+    {
+        PROFILE_SCOPE("Controller tick");
+        AllocationCounter::ScopedIgnore ignoreController;
         m_pControl->tick(deltaTSec);
+    }
+}
 
-    for (Entity* pBuilding : m_Buildings) {
-        if (!pBuilding->isDead()) {
-            pBuilding->tick(deltaTSec);
+void Player::getLiveEntities(std::vector<Entity*>& outEntities) const
+{
+    // Reading the health straight from the stores.
+    const std::vector<Entity*>& buildings = m_BuildingStore.getEntities();
+    const std::vector<int>& buildingHealths = m_BuildingStore.getHealths();
+    for (unsigned int i = 0; i < m_BuildingStore.size(); ++i)
+    {
+        if (buildingHealths[i] > 0)
+        {
+            outEntities.push_back(buildings[i]);
         }
     }
 
-    for (Entity* m : m_Mobs) {
-        if (!m->isDead()) {
-            m->tick(deltaTSec);
+    const std::vector<Entity*>& mobs = m_MobStore.getEntities();
+    const std::vector<int>& mobHealths = m_MobStore.getHealths();
+    for (unsigned int i = 0; i < m_MobStore.size(); ++i)
+    {
+        if (mobHealths[i] > 0)
+        {
+            outEntities.push_back(mobs[i]);
         }
     }
+}
+
+void Player::freeDeadMobs()
+{
+    PROFILE_SCOPE("Free dead mobs");
+    m_DeadMobs.clear();
+    m_MobStore.removeDead(m_DeadMobs);
+    for (Entity* pEntity : m_DeadMobs)
+    {
+        m_MobPool.free(static_cast<Mob*>(pEntity));
+    }
+}
+
+void Player::updateOccluders()
+{
+    m_TowerVisibility.update(m_BuildingStore);
+
+    m_Occluders.clear();
 
-    // Move any mobs that died this tick into m_DeadMobs
-    size_t newIndex = 0;
-    for (size_t oldIndex = 0; oldIndex < m_Mobs.size(); ++oldIndex)
+    const std::vector<Vec2>& buildingPositions = m_BuildingStore.getPositions();
+    const std::vector<int>& buildingHealths = m_BuildingStore.getHealths();
+    for (unsigned int i = 0; i < m_BuildingStore.size(); ++i)
     {
-        Entity* pMob = m_Mobs[oldIndex];
-        if (!pMob->isDead())
+        if (buildingHealths[i] > 0)
         {
-            Entity* pTemp = m_Mobs[newIndex];
-            m_Mobs[newIndex] = m_Mobs[oldIndex];
-            m_Mobs[oldIndex] = pTemp;
-            ++newIndex;
+            m_Occluders.addBox(buildingPositions[i], m_BuildingStore.getStatsData(i).m_Size);
         }
-        else
+    }
+
+    m_Occluders.beginDynamic();
+
+    const std::vector<Vec2>& mobPositions = m_MobStore.getPositions();
+    const std::vector<int>& mobHealths = m_MobStore.getHealths();
+    const std::vector<int>& mobTypes = m_MobStore.getStatsIndices();
+    for (unsigned int i = 0; i < m_MobStore.size(); ++i)
+    {
+        if ((mobHealths[i] > 0) && (mobTypes[i] == iEntityStats::Giant))
         {
-            m_DeadMobs.push_back(m_Mobs[oldIndex]);
+            m_Occluders.addBox(mobPositions[i], m_MobStore.getStatsData(i).m_Size);
         }
     }
+}
 
-    assert(newIndex <= m_Mobs.size());
-    m_Mobs.resize(newIndex);
+Entity* Player::getEntity(const EntityHandle& handle) const
+{
+    assert(handle.m_bNorth == m_bNorth);
+
+    if (handle.m_bBuilding)
+    {
+        return (handle.m_Index < m_BuildingStore.size()) ? getBuildings()[handle.m_Index] : NULL;
+    }
+
+    return m_MobPool.get(handle);
 }
 
 iPlayer::EntityData Player::getBuilding(unsigned int i) const
 {
-    if (i < m_Buildings.size())
+    if (i < m_BuildingStore.size())
     {
-        return m_Buildings[i]->getData();
+        return getBuildings()[i]->getData();
     }
 
     return EntityData();
@@ -174,9 +255,9 @@ iPlayer::EntityData Player::getBuilding(unsigned int i) const
 
 iPlayer::EntityData Player::getMob(unsigned int i) const
 {
-    if (i < m_Mobs.size())
+    if (i < m_MobStore.size())
     {
-        return m_Mobs[i]->getData();
+        return getMobs()[i]->getData();
     }
 
     return EntityData();
@@ -207,23 +288,121 @@ void Player::buildBuildings()
     const iEntityStats& kingStats = iEntityStats::getBuildingStats(iEntityStats::King);
     const iEntityStats& princessStats = iEntityStats::getBuildingStats(iEntityStats::Princess);
 
+    // NOTE: the buildings add themselves to the store, which owns them
     if (m_bNorth)
     {
-        m_Buildings.push_back(new Building(kingStats, Vec2(KingX, NorthKingY), true));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessLeftX, NorthPrincessY), true));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessRightX, NorthPrincessY), true));
+        new Building(m_Game, m_BuildingStore, kingStats, Vec2(KingX, NorthKingY), true);
+        new Building(m_Game, m_BuildingStore, princessStats, Vec2(PrincessLeftX, NorthPrincessY), true);
+        new Building(m_Game, m_BuildingStore, princessStats, Vec2(PrincessRightX, NorthPrincessY), true);
     }
     else
     {
-        m_Buildings.push_back(new Building(kingStats, Vec2(KingX, SouthKingY), false));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessLeftX, SouthPrincessY), false));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessRightX, SouthPrincessY), false));
+        new Building(m_Game, m_BuildingStore, kingStats, Vec2(KingX, SouthKingY), false);
+        new Building(m_Game, m_BuildingStore, princessStats, Vec2(PrincessLeftX, SouthPrincessY), false);
+        new Building(m_Game, m_BuildingStore, princessStats, Vec2(PrincessRightX, SouthPrincessY), false);
+    }
+
+    // The towers never move, so which sight lines they block is worked out 
+    // once, here.
+    const std::vector<Vec2>& buildingPositions = m_BuildingStore.getPositions();
+    for (unsigned int i = 0; i < m_BuildingStore.size(); ++i)
+    {
+        m_TowerVisibility.addTower(buildingPositions[i], m_BuildingStore.getStatsData(i).m_Size);
+    }
+}
+
+void Player::takeSnapshot(GameSnapshot& outSnapshot) const
+{
+    m_Game.takeSnapshot(outSnapshot);
+}
+
+iSandbox* Player::createSandbox() const
+{
+    return new Sandbox;
+}
+
+void Player::saveState(PlayerSnapshot& out, std::vector<EntitySnapshot>& outEntities) const
+{
+    out.m_Elixir = m_Elixir;
+    out.m_FirstEntity = (unsigned int)outEntities.size();
+    out.m_NumBuildings = m_BuildingStore.size();
+    out.m_NumMobs = m_MobStore.size();
+    out.m_NextMobGeneration = m_MobPool.getNextGeneration();
+
+    // NOTE: this only allocates if the snapshot has never held this many 
+    // entities before.
+    outEntities.resize(out.m_FirstEntity + out.m_NumBuildings + out.m_NumMobs);
+    EntitySnapshot* pOut = outEntities.data() + out.m_FirstEntity;
+
+    for (const Entity* pBuilding : getBuildings())
+    {
+        pBuilding->saveState(*pOut++);
+    }
+
+    // NOTE: mobs that die are freed at the end of the tick they die in (see
+    // Game::tick()), so there are no dead ones to save.
+    for (const Entity* pMob : getMobs())
+    {
+        assert(!pMob->isDead());
+        pMob->saveState(*pOut++);
     }
 }
 
+void Player::loadState(const PlayerSnapshot& in, const std::vector<EntitySnapshot>& entities)
+{
+    assert(in.m_NumBuildings == m_BuildingStore.size());
+    assert(in.m_FirstEntity + in.m_NumBuildings + in.m_NumMobs <= entities.size());
+
+    m_Elixir = in.m_Elixir;
+
+    const EntitySnapshot* pIn = entities.data() + in.m_FirstEntity;
+    for (Entity* pBuilding : getBuildings())
+    {
+        pBuilding->loadState(*pIn++);
+    }
+
+    // Rebuild the mobs from scratch, in the order they were in, each in the
+    // pool slot it had.
+    for (Entity* pMob : getMobs())
+    {
+        m_MobPool.free(static_cast<Mob*>(pMob));
+    }
+    m_MobStore.clear();
+    for (unsigned int i = 0; i < in.m_NumMobs; ++i, ++pIn)
+    {
+        assert(pIn->m_Handle.m_bNorth == m_bNorth);
+        const iEntityStats& stats = iEntityStats::getStats((iEntityStats::MobType)pIn->m_StatsIndex);
+        Mob* pMob = m_MobPool.createAt(pIn->m_Handle.m_Index, pIn->m_Handle.m_Generation, 
+                                       m_Game, m_MobStore, stats, pIn->m_Pos);
+        pMob->loadState(*pIn);
+    }
+    m_MobPool.setNextGeneration(in.m_NextMobGeneration);
+}
+
+void Player::hashState(StateHash& hash) const
+{
+    hash.add(m_Elixir);
+
+    hash.add(m_BuildingStore.size());
+    for (const Entity* pBuilding : getBuildings())
+    {
+        pBuilding->hashState(hash);
+    }
+
+    hash.add(m_MobStore.size());
+    for (const Entity* pMob : getMobs())
+    {
+        pMob->hashState(hash);
+    }
+
+    // The slots our next mobs go in follow from the live mobs, but their 
+    // generations don't.
+    hash.add(m_MobPool.getNextGeneration());
+}
+
 const Player& Player::GetOpponent() const
 {
-    const Player& opPlayer = Game::get().getPlayer(!m_bNorth);
+    const Player& opPlayer = m_Game.getPlayer(!m_bNorth);
     assert(&opPlayer != this);
     return opPlayer;
 }
@@ -25,16 +25,23 @@
 #include "iPlayer.h"
 
 #include "Constants.h"
+#include "EntityStore.h"
+#include "GameSnapshot.h"
+#include "MobPool.h"
+#include "Occluders.h"
+#include "TowerVisibility.h"
 #include <algorithm>
 #include <assert.h>
 
 class iController;
 class Entity;
+class Game;
+class StateHash;
 
 class Player : public iPlayer {
 public:
     // NOTE: we take ownership of the controller
-    explicit Player(iController* pControl, bool bNorth);
+    explicit Player(Game& game, iController* pControl, bool bNorth);
     virtual ~Player();
 
     virtual bool isNorth() const { return m_bNorth; }
@@ -43,15 +50,42 @@ public:
     virtual const std::vector<iEntityStats::MobType>& GetAvailableMobTypes() const { return m_AvailableMobs; }
     virtual PlacementResult placeMob(iEntityStats::MobType type, const Vec2& pos);
 
+    // Gains elixir, and lets the controller act.  The entities are ticked 
+    // by the Game, for both players at once.
     void tick(float deltaTSec);
 
-    const std::vector<Entity*>& getBuildings() const { return m_Buildings; }
-    const std::vector<Entity*>& getMobs() const { return m_Mobs; }
+    // Appends our live buildings, then our live mobs, to outEntities.
+    void getLiveEntities(std::vector<Entity*>& outEntities) const;
 
-    virtual unsigned int getNumBuildings() const { return (unsigned int)m_Buildings.size(); }
+    // Frees any mobs that died this tick.
+    void freeDeadMobs();
+
+    Game& getGame() const { return m_Game; }
+
+    const std::vector<Entity*>& getBuildings() const { return m_BuildingStore.getEntities(); }
+    const std::vector<Entity*>& getMobs() const { return m_MobStore.getEntities(); }
+
+    // The state of our live mobs (and buildings), as structures of arrays.
+    const EntityStore& getMobStore() const { return m_MobStore; }
+    const EntityStore& getBuildingStore() const { return m_BuildingStore; }
+
+    // Returns one of our entities, or NULL if it has been freed.
+    Entity* getEntity(const EntityHandle& handle) const;
+
+    // The boxes of our live towers and Giants, which block line of sight for
+    // our Rogues.  Rebuilt by updateOccluders() at the start of each tick.
+    // The towers are static and the Giants dynamic (see Occluders).
+    const Occluders& getOccluders() const { return m_Occluders; }
+    void updateOccluders();
+
+    // Which pairs of tiles our towers block the line of sight between, as of
+    // the last updateOccluders().
+    const TowerVisibility& getTowerVisibility() const { return m_TowerVisibility; }
+
+    virtual unsigned int getNumBuildings() const { return m_BuildingStore.size(); }
     virtual EntityData getBuilding(unsigned int i) const;
 
-    virtual unsigned int getNumMobs() const { return (unsigned int)m_Mobs.size(); }
+    virtual unsigned int getNumMobs() const { return m_MobStore.size(); }
     virtual EntityData getMob(unsigned int i) const;
 
     virtual unsigned int getNumOpponentBuildings() const { return GetOpponent().getNumBuildings(); }
@@ -60,6 +94,17 @@ public:
     virtual unsigned int getNumOpponentMobs() const { return GetOpponent().getNumMobs(); }
     virtual EntityData getOpponentMob(unsigned int i) const;
 
+    virtual void takeSnapshot(GameSnapshot& outSnapshot) const;
+    virtual iSandbox* createSandbox() const;
+
+    // Appends our entities to outEntities, and fills out our part of the 
+    // snapshot.  loadState() puts them back, recreating our mobs.
+    void saveState(PlayerSnapshot& out, std::vector<EntitySnapshot>& outEntities) const;
+    void loadState(const PlayerSnapshot& in, const std::vector<EntitySnapshot>& entities);
+
+    // Folds the same state into the hash.  See StateHash.
+    void hashState(StateHash& hash) const;
+
 private:
     void buildBuildings();
 
@@ -68,6 +113,7 @@ private:
     float capElixir(float e) const { return std::max(e, MAX_ELIXIR); }
 
 private:
+    Game& m_Game;
     iController* m_pControl;                // owned, may be NULL
 
     bool m_bNorth;
@@ -75,11 +121,18 @@ private:
 
     std::vector<iEntityStats::MobType> m_AvailableMobs;
 
-    std::vector<Entity*> m_Buildings;       // owned
-    std::vector<Entity*> m_Mobs;            // owned
+    EntityStore m_BuildingStore;            // owns the buildings
+    EntityStore m_MobStore;                 // the live mobs
+
+    // Owns the mobs.  When mobs die we free them at the end of the tick, and
+    // their slots are reused by later spawns.  Anything that refers to a mob
+    // across ticks holds an EntityHandle, so nothing is left dangling.
+    MobPool m_MobPool;
+
+    // Scratch space for freeDeadMobs(), kept around to avoid reallocating
+    std::vector<Entity*> m_DeadMobs;
 
-    // When mobs die, we move them to this vector.  For now we just hang on to 
-    // them forever - we never delete them - so as to avoid memory issues.
-    std::vector<Entity*> m_DeadMobs;        // owned
+    Occluders m_Occluders;
+    TowerVisibility m_TowerVisibility;
 
 };
@@ -0,0 +1,154 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+
+#include <fstream>
+#include <stdio.h>
+
+Profiler* Singleton<Profiler>::s_Obj = NULL;
+
+std::atomic<bool> Profiler::s_bRecording(false);
+thread_local int Profiler::s_MuteDepth = 0;
+thread_local Profiler::ThreadBuffer* Profiler::s_pThreadBuffer = NULL;
+
+// Each thread's buffer starts this big, so that a few seconds of profiling 
+// doesn't reallocate in the middle of a frame.
+const size_t PROFILER_INITIAL_EVENTS = 64 * 1024;
+
+Profiler::Profiler()
+{
+    // Start the clock.
+    now();
+}
+
+Profiler::~Profiler()
+{
+    stop();
+
+    // NOTE: any thread that recorded is left holding a dangling buffer 
+    // pointer, which is why the profiler only goes away at exit.
+    for (ThreadBuffer* pBuffer : m_Buffers)
+    {
+        delete pBuffer;
+    }
+}
+
+void Profiler::shutdown()
+{
+    if (exists())
+    {
+        delete &get();
+    }
+}
+
+void Profiler::start()
+{
+    s_bRecording = true;
+}
+
+void Profiler::stop()
+{
+    s_bRecording = false;
+}
+
+int64_t Profiler::now()
+{
+    using namespace std::chrono;
+    static const steady_clock::time_point s_Epoch = steady_clock::now();
+    return duration_cast<nanoseconds>(steady_clock::now() - s_Epoch).count();
+}
+
+void Profiler::instant(const char* name)
+{
+    if (isRecording() && (s_MuteDepth == 0))
+    {
+        record(name, now(), -1);
+    }
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t durationNs)
+{
+    Event event;
+    event.m_Name = name;
+    event.m_StartNs = startNs;
+    event.m_DurationNs = durationNs;
+    get().getThreadBuffer().m_Events.push_back(event);
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+{
+    if (!s_pThreadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        s_pThreadBuffer = new ThreadBuffer;
+        s_pThreadBuffer->m_ThreadId = (unsigned int)m_Buffers.size() + 1;
+        s_pThreadBuffer->m_Events.reserve(PROFILER_INITIAL_EVENTS);
+        m_Buffers.push_back(s_pThreadBuffer);
+    }
+    return *s_pThreadBuffer;
+}
+
+bool Profiler::save(const std::string& path) const
+{
+    std::ofstream file(path.c_str(), std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    // The Trace Event Format: complete ("X") events for the scopes, and 
+    // thread-scoped instant ("i") events, with times in microseconds.
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool bFirst = true;
+    char line[256];
+    for (const ThreadBuffer* pBuffer : m_Buffers)
+    {
+        for (const Event& event : pBuffer->m_Events)
+        {
+            if (event.m_DurationNs >= 0)
+            {
+                snprintf(line, sizeof(line), 
+                         "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         bFirst ? "" : ",\n", event.m_Name, pBuffer->m_ThreadId,
+                         event.m_StartNs / 1000.0, event.m_DurationNs / 1000.0);
+            }
+            else
+            {
+                snprintf(line, sizeof(line),
+                         "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                         bFirst ? "" : ",\n", event.m_Name, pBuffer->m_ThreadId,
+                         event.m_StartNs / 1000.0);
+            }
+            file << line;
+            bFirst = false;
+        }
+    }
+    file << "\n]}\n";
+
+    return !!file;
+}
+
+#endif
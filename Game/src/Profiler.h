@@ -0,0 +1,155 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Scoped timers for the main loop and the simulation, saved as a Chrome trace
+// (open it in chrome://tracing or https://ui.perfetto.dev) so that a slow 
+// frame can be broken down into the phases that made it slow.
+//
+// Usage:  PROFILE_SCOPE("Mob ticks");     // times the rest of the block
+//
+// The whole thing is compiled out unless PROFILER_ENABLED is defined to 1: 
+// the macros expand to nothing, and the Profiler class doesn't exist.  When
+// it is compiled in, nothing is recorded until start() is called, and a 
+// scope that isn't being recorded costs a single atomic load.
+//
+// NOTE: names must be string literals (or otherwise outlive the profiler),
+// since we only keep the pointer.
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+#if PROFILER_ENABLED
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Times from here to the end of the enclosing block.
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+// Marks a moment (e.g. the simulation falling behind) on the timeline.
+#define PROFILE_INSTANT(name) Profiler::instant(name)
+
+// Stops recording on the calling thread for the rest of the block - e.g.
+// while a Sandbox plays out a lookahead, which would otherwise bury the real
+// ticks.  These nest.
+#define PROFILE_MUTE() Profiler::ScopedMute PROFILE_CONCAT(profileMute_, __LINE__)
+
+#include "Singleton.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Profiler : public Singleton<Profiler>
+{
+public:
+    Profiler();
+    virtual ~Profiler();
+
+    // Events are only recorded between start() and stop().  Every thread 
+    // records into its own buffer, so any thread may be profiled.
+    void start();
+    void stop();
+
+    static bool isRecording() { return s_bRecording.load(std::memory_order_relaxed); }
+
+    // Writes everything recorded so far as Chrome trace JSON.  Call this when
+    // the profiled threads have finished (or after stop()).
+    bool save(const std::string& path) const;
+
+    static void instant(const char* name);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : m_Name((isRecording() && (s_MuteDepth == 0)) ? name : NULL)
+            , m_StartNs(m_Name ? now() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_Name)
+            {
+                record(m_Name, m_StartNs, now() - m_StartNs);
+            }
+        }
+
+    private:
+        const char* m_Name;         // NULL => not recording
+        int64_t m_StartNs;
+    };
+
+    class ScopedMute
+    {
+    public:
+        ScopedMute() { ++s_MuteDepth; }
+        ~ScopedMute() { --s_MuteDepth; }
+    };
+
+    // Stops recording and destroys the profiler.  Call this before exiting.
+    static void shutdown();
+
+private:
+    struct Event
+    {
+        const char* m_Name;
+        int64_t m_StartNs;
+        int64_t m_DurationNs;       // < 0 => an instant
+    };
+
+    struct ThreadBuffer
+    {
+        unsigned int m_ThreadId;    // in the order the threads first recorded
+        std::vector<Event> m_Events;
+    };
+
+    // Nanoseconds since the program started.
+    static int64_t now();
+
+    static void record(const char* name, int64_t startNs, int64_t durationNs);
+
+    // The calling thread's buffer, which is made the first time it records.
+    ThreadBuffer& getThreadBuffer();
+
+private:
+    static std::atomic<bool> s_bRecording;
+    static thread_local int s_MuteDepth;
+    static thread_local ThreadBuffer* s_pThreadBuffer;
+
+    mutable std::mutex m_Mutex;             // guards m_Buffers
+    std::vector<ThreadBuffer*> m_Buffers;   // owned
+};
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_INSTANT(name) ((void)0)
+#define PROFILE_MUTE() ((void)0)
+
+#endif
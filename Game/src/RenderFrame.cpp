@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RenderFrame.h"
+
+#include "EntityStore.h"
+#include "Game.h"
+#include "Player.h"
+
+#include <chrono>
+
+namespace
+{
+    // Appends the entities in the store.
+    void captureEntities(const EntityStore& store, bool bNorth, bool bLiveOnly, std::vector<RenderEntity>& out)
+    {
+        const std::vector<Vec2>& positions = store.getPositions();
+        const std::vector<int>& healths = store.getHealths();
+        const std::vector<unsigned char>& hidden = store.getHidden();
+        for (unsigned int i = 0; i < store.size(); ++i)
+        {
+            if (bLiveOnly && (healths[i] <= 0))
+            {
+                continue;
+            }
+
+            const EntityStatsData& stats = store.getStatsData(i);
+
+            RenderEntity entity;
+            entity.m_Pos = positions[i];
+            entity.m_Size = stats.m_Size;
+            entity.m_Health = healths[i];
+            entity.m_MaxHealth = stats.m_MaxHealth;
+            entity.m_bNorth = bNorth;
+            entity.m_bHidden = hidden[i] != 0;
+            entity.m_DisplayLetter = stats.m_DisplayLetter;
+            out.push_back(entity);
+        }
+    }
+}
+
+RenderFrame::RenderFrame()
+    : m_NorthElixir(0.f)
+    , m_SouthElixir(0.f)
+    , m_Winner(0)
+{
+}
+
+void RenderFrame::capture(Game& game)
+{
+    // NOTE: clear() keeps the capacity, so once the frames have grown to fit
+    // the battle, capturing doesn't allocate.
+    m_Buildings.clear();
+    m_Mobs.clear();
+
+    for (int i = 0; i < 2; ++i)
+    {
+        const bool bNorth = (i == 0);
+        const Player& player = game.getPlayer(bNorth);
+        captureEntities(player.getBuildingStore(), bNorth, false, m_Buildings);
+        captureEntities(player.getMobStore(), bNorth, true, m_Mobs);
+    }
+
+    m_NorthElixir = game.getPlayer(true).getElixir();
+    m_SouthElixir = game.getPlayer(false).getElixir();
+    m_Winner = game.checkGameOver();
+}
+
+RenderFrameBuffer::RenderFrameBuffer()
+    : m_pWrite(&m_Frames[0])
+    , m_pReady(&m_Frames[1])
+    , m_pRead(&m_Frames[2])
+    , m_bReadyIsNew(false)
+{
+}
+
+void RenderFrameBuffer::publish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::swap(m_pWrite, m_pReady);
+        m_bReadyIsNew = true;
+    }
+    m_Published.notify_one();
+}
+
+bool RenderFrameBuffer::acquire(double waitSec)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_bReadyIsNew && (waitSec > 0.0))
+    {
+        m_Published.wait_for(lock, std::chrono::duration<double>(waitSec), [this]() { return m_bReadyIsNew; });
+    }
+
+    if (!m_bReadyIsNew)
+    {
+        return false;
+    }
+
+    std::swap(m_pRead, m_pReady);
+    m_bReadyIsNew = false;
+    return true;
+}
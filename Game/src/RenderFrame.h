@@ -0,0 +1,99 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Vec2.h"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+class Game;
+
+// One building or mob, as Graphics draws it.
+struct RenderEntity
+{
+    Vec2 m_Pos;
+    float m_Size;
+    int m_Health;
+    int m_MaxHealth;
+    bool m_bNorth;
+    bool m_bHidden;
+    const char* m_DisplayLetter;    // from the stats tables, so it never goes away
+};
+
+// Everything the render thread needs to draw the game as it was at the end of
+// one tick.  It's a copy, so the simulation can carry on ticking while it's 
+// drawn, and nothing on the render thread ever touches a live Entity.
+struct RenderFrame
+{
+    RenderFrame();
+
+    // Copies the game's current state into the frame.  NOTE: call this from
+    // the thread that ticks the game.
+    void capture(Game& game);
+
+    std::vector<RenderEntity> m_Buildings;  // including dead ones, which are drawn as ruins
+    std::vector<RenderEntity> m_Mobs;       // live ones only
+
+    float m_NorthElixir;
+    float m_SouthElixir;
+    int m_Winner;                           // as Game::checkGameOver()
+};
+
+// Hands frames from the simulation thread to the render thread.  The frames 
+// are double buffered - one is drawn while the next is filled in - with a 
+// spare in between, which holds the latest finished frame.  Publishing and
+// acquiring just swap pointers under a lock, so neither thread ever waits 
+// for the other to finish drawing or ticking.
+class RenderFrameBuffer
+{
+public:
+    RenderFrameBuffer();
+
+    // Simulation thread: fill in the write frame, then publish() it.  The
+    // write frame is then a different (stale) frame, so fill it in from 
+    // scratch each time.
+    RenderFrame& getWriteFrame() { return *m_pWrite; }
+    void publish();
+
+    // Render thread: swaps in the latest published frame, if there's one we
+    // haven't drawn yet, waiting up to waitSec for it.  Returns true if we 
+    // got a new frame.  Either way, getReadFrame() is the latest we have.
+    bool acquire(double waitSec);
+    const RenderFrame& getReadFrame() const { return *m_pRead; }
+
+private:
+    RenderFrame m_Frames[3];
+    RenderFrame* m_pWrite;
+    RenderFrame* m_pReady;
+    RenderFrame* m_pRead;
+    bool m_bReadyIsNew;                     // m_pReady has been published since the last acquire()
+
+    std::mutex m_Mutex;                     // guards the swaps
+    std::condition_variable m_Published;
+
+private:
+    // DELIBERATELY UNDEFINED
+    RenderFrameBuffer(const RenderFrameBuffer& rhs);
+    RenderFrameBuffer& operator=(const RenderFrameBuffer& rhs);
+};
@@ -0,0 +1,341 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Replay.h"
+
+#include "Constants.h"
+#include "iPlayer.h"
+#include <assert.h>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+
+static const char ksReplayMagic[4] = { 'C', 'L', 'R', 'P' };
+
+static uint32_t floatBits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float bitsToFloat(uint32_t bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint32_t zigzag(uint32_t delta)
+{
+    const int32_t n = (int32_t)delta;
+    return ((uint32_t)n << 1) ^ (uint32_t)(n >> 31);
+}
+
+static uint32_t unzigzag(uint32_t value)
+{
+    return (value >> 1) ^ (0u - (value & 1u));
+}
+
+static void writeVarint(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReplayPlacement
+
+int ReplayPlacement::getTileX() const
+{
+    return m_Tile % GAME_GRID_WIDTH;
+}
+
+int ReplayPlacement::getTileY() const
+{
+    return m_Tile / GAME_GRID_WIDTH;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReplayRecorder
+
+ReplayRecorder::ReplayRecorder()
+    : m_NumTicks(0)
+    , m_bInTick(false)
+    , m_DeltaTSec(0.f)
+    , m_SkippedTicks(0)
+    , m_LastDeltaTBits(0)
+    , m_LastTile(0)
+{
+}
+
+void ReplayRecorder::beginTick(float deltaTSec)
+{
+    endTick();
+
+    m_bInTick = true;
+    m_DeltaTSec = deltaTSec;
+    ++m_NumTicks;
+}
+
+void ReplayRecorder::recordPlacement(bool bNorth, iEntityStats::MobType type, int tileX, int tileY)
+{
+    assert(m_bInTick);
+    assert((tileX >= 0) && (tileX < GAME_GRID_WIDTH));
+
+    ReplayPlacement placement;
+    placement.m_bNorth = bNorth;
+    placement.m_Type = type;
+    placement.m_Tile = tileY * GAME_GRID_WIDTH + tileX;
+    m_Placements.push_back(placement);
+}
+
+void ReplayRecorder::endTick()
+{
+    if (!m_bInTick)
+    {
+        return;
+    }
+    m_bInTick = false;
+
+    // Most ticks are just like the last one, so we only count them.
+    const uint32_t deltaTBits = floatBits(m_DeltaTSec);
+    if ((deltaTBits == m_LastDeltaTBits) && m_Placements.empty() && (m_NumTicks > 1))
+    {
+        ++m_SkippedTicks;
+        return;
+    }
+
+    writeVarint(m_Bytes, m_SkippedTicks);
+    writeVarint(m_Bytes, zigzag(deltaTBits - m_LastDeltaTBits));
+    writeVarint(m_Bytes, (uint32_t)m_Placements.size());
+    for (const ReplayPlacement& placement : m_Placements)
+    {
+        writeVarint(m_Bytes, ((uint32_t)placement.m_Type << 1) | (placement.m_bNorth ? 1u : 0u));
+        writeVarint(m_Bytes, zigzag((uint32_t)(placement.m_Tile - m_LastTile)));
+        m_LastTile = placement.m_Tile;
+    }
+
+    m_SkippedTicks = 0;
+    m_LastDeltaTBits = deltaTBits;
+    m_Placements.clear();
+}
+
+bool ReplayRecorder::save(const std::string& path)
+{
+    endTick();
+
+    std::vector<uint8_t> header(ksReplayMagic, ksReplayMagic + sizeof(ksReplayMagic));
+    writeVarint(header, REPLAY_VERSION);
+    writeVarint(header, (uint32_t)GAME_GRID_WIDTH);
+    writeVarint(header, m_NumTicks);
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write((const char*)header.data(), header.size());
+    file.write((const char*)m_Bytes.data(), m_Bytes.size());
+    return !!file;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReplayReader
+
+ReplayReader::ReplayReader()
+    : m_Pos(0)
+    , m_bCorrupt(false)
+    , m_NumTicks(0)
+    , m_TickIndex(0)
+    , m_DeltaTSec(0.f)
+    , m_SkippedTicks(0)
+    , m_bRecordPending(false)
+    , m_LastDeltaTBits(0)
+    , m_LastTile(0)
+{
+}
+
+bool ReplayReader::load(const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        printf("Couldn't open replay %s\n", path.c_str());
+        return false;
+    }
+
+    m_Bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_Pos = 0;
+    m_bCorrupt = false;
+
+    uint32_t version = 0;
+    uint32_t gridWidth = 0;
+    uint32_t numTicks = 0;
+    if ((m_Bytes.size() < sizeof(ksReplayMagic)) || (memcmp(m_Bytes.data(), ksReplayMagic, sizeof(ksReplayMagic)) != 0))
+    {
+        printf("%s is not a replay\n", path.c_str());
+        return false;
+    }
+    m_Pos = sizeof(ksReplayMagic);
+
+    if (!readVarint(version) || (version != REPLAY_VERSION))
+    {
+        printf("%s is replay version %u, but we only read version %u\n", path.c_str(), version, REPLAY_VERSION);
+        return false;
+    }
+
+    if (!readVarint(gridWidth) || (gridWidth != (uint32_t)GAME_GRID_WIDTH) || !readVarint(numTicks))
+    {
+        printf("%s was recorded with a different game grid\n", path.c_str());
+        return false;
+    }
+
+    m_NumTicks = numTicks;
+    m_TickIndex = 0;
+    m_SkippedTicks = 0;
+    m_bRecordPending = false;
+    m_LastDeltaTBits = 0;
+    m_LastTile = 0;
+
+    decodeTick();
+    if (m_bCorrupt)
+    {
+        printf("%s is corrupt\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void ReplayReader::advance()
+{
+    assert(!isFinished());
+    ++m_TickIndex;
+    if (!isFinished())
+    {
+        decodeTick();
+    }
+
+    if (m_bCorrupt)
+    {
+        // Stop here, rather than play garbage.
+        printf("Replay is corrupt after tick %u\n", m_TickIndex);
+        m_NumTicks = m_TickIndex;
+    }
+}
+
+void ReplayReader::decodeTick()
+{
+    m_Placements.clear();
+
+    if ((m_SkippedTicks == 0) && !m_bRecordPending && (m_Pos < m_Bytes.size()))
+    {
+        m_bCorrupt |= !readVarint(m_SkippedTicks);
+        m_bRecordPending = true;
+    }
+
+    // A skipped tick (or one after the last record) is just like the last one.
+    if (m_SkippedTicks > 0)
+    {
+        --m_SkippedTicks;
+        return;
+    }
+    if (!m_bRecordPending)
+    {
+        return;
+    }
+    m_bRecordPending = false;
+
+    uint32_t deltaTDiff = 0;
+    uint32_t numPlacements = 0;
+    m_bCorrupt |= !readVarint(deltaTDiff) || !readVarint(numPlacements);
+    m_LastDeltaTBits += unzigzag(deltaTDiff);
+    m_DeltaTSec = bitsToFloat(m_LastDeltaTBits);
+
+    for (uint32_t i = 0; (i < numPlacements) && !m_bCorrupt; ++i)
+    {
+        uint32_t typeAndSide = 0;
+        uint32_t tileDiff = 0;
+        m_bCorrupt |= !readVarint(typeAndSide) || !readVarint(tileDiff);
+        m_LastTile = (int)((uint32_t)m_LastTile + unzigzag(tileDiff));
+
+        ReplayPlacement placement;
+        placement.m_bNorth = (typeAndSide & 1) != 0;
+        placement.m_Type = (iEntityStats::MobType)(typeAndSide >> 1);
+        placement.m_Tile = m_LastTile;
+        if ((typeAndSide >> 1) >= (uint32_t)iEntityStats::numMobTypes)
+        {
+            m_bCorrupt = true;
+            break;
+        }
+        m_Placements.push_back(placement);
+    }
+}
+
+bool ReplayReader::readVarint(uint32_t& outValue)
+{
+    outValue = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7)
+    {
+        if (m_Pos >= m_Bytes.size())
+        {
+            return false;
+        }
+
+        const uint8_t byte = m_Bytes[m_Pos++];
+        outValue |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReplayController
+
+ReplayController::ReplayController(const ReplayReader& reader, bool bNorth)
+    : m_Reader(reader)
+    , m_bNorth(bNorth)
+{
+}
+
+void ReplayController::tick(float deltaTSec)
+{
+    assert(m_pPlayer && (m_pPlayer->isNorth() == m_bNorth));
+    assert(!m_Reader.isFinished() && (deltaTSec == m_Reader.getDeltaT()));
+
+    for (const ReplayPlacement& placement : m_Reader.getPlacements())
+    {
+        if (placement.m_bNorth == m_bNorth)
+        {
+            const Vec2 pos((float)placement.getTileX() + 0.5f, (float)placement.getTileY() + 0.5f);
+            const iPlayer::PlacementResult result = m_pPlayer->placeMob(placement.m_Type, pos);
+            assert(result == iPlayer::Success);
+            (void)result;
+        }
+    }
+}
@@ -0,0 +1,166 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "iController.h"
+
+#include "EntityStats.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Replays.  Since the simulation is deterministic, a match is completely
+// described by the dt of each tick and the mobs that each player placed 
+// during it, so that's all we record.  Playing a replay feeds the same 
+// placements back in, through a ReplayController on each side.
+//
+// The file is a header followed by a stream of varints:
+//   "CLRP", version, grid width, number of ticks
+//   then for each tick that either has placements or a different dt than 
+//   the tick before:
+//     the number of ticks skipped since the last record (which all had the 
+//       same dt, and no placements)
+//     the dt, as the difference between its bits and the last dt's bits
+//     the number of placements, and for each of them:
+//       (mob type << 1) | isNorth
+//       the tile index (y * GAME_GRID_WIDTH + x), as the difference from the 
+//         last placement's tile
+// Differences are zigzag encoded, so small negative numbers stay small.  Any
+// ticks after the last record are just like the ones skipped before it.
+// With a fixed dt, a ten minute match comes to a few hundred bytes.
+
+// A replay only holds the inputs, so it only plays back to the same match on
+// the simulation that recorded it.  Bump the version whenever the simulation
+// changes how a match plays out, so old replays are turned away rather than 
+// quietly playing out differently.
+//   1: the original format
+//   2: mobs route with the flow fields
+//   3: entities decide, and then apply, simultaneously
+//   4: placements off the field are turned away
+const uint32_t REPLAY_VERSION = 4;
+
+// A mob placed during one tick, as recorded.
+struct ReplayPlacement
+{
+    bool m_bNorth;
+    iEntityStats::MobType m_Type;
+    int m_Tile;                     // y * GAME_GRID_WIDTH + x
+
+    int getTileX() const;
+    int getTileY() const;
+};
+
+// Builds up a replay as a match is played.  See Game::setRecorder().
+class ReplayRecorder
+{
+public:
+    ReplayRecorder();
+
+    // Call at the start of each tick, before anything is placed.
+    void beginTick(float deltaTSec);
+
+    // Call when a placement succeeds.  The tile is the one the mob was 
+    // placed in.
+    void recordPlacement(bool bNorth, iEntityStats::MobType type, int tileX, int tileY);
+
+    unsigned int getNumTicks() const { return m_NumTicks; }
+
+    // Writes out everything recorded so far.  Returns false if the file 
+    // couldn't be written.
+    bool save(const std::string& path);
+
+private:
+    // Encodes the tick that's in progress.
+    void endTick();
+
+private:
+    std::vector<uint8_t> m_Bytes;   // the records, not including the header
+
+    unsigned int m_NumTicks;
+    bool m_bInTick;
+    float m_DeltaTSec;
+    std::vector<ReplayPlacement> m_Placements;
+
+    // Delta encoding state
+    uint32_t m_SkippedTicks;
+    uint32_t m_LastDeltaTBits;
+    int m_LastTile;
+};
+
+// Decodes a replay, a tick at a time.  The current tick (the one about to be
+// simulated) is always decoded, so its dt and placements can be read before
+// it is played.
+class ReplayReader
+{
+public:
+    ReplayReader();
+
+    // Returns false (and prints why) if the file can't be read or isn't a
+    // replay.
+    bool load(const std::string& path);
+
+    unsigned int getNumTicks() const { return m_NumTicks; }
+    unsigned int getTickIndex() const { return m_TickIndex; }
+    bool isFinished() const { return m_TickIndex >= m_NumTicks; }
+
+    // The current tick.  Only valid if !isFinished().
+    float getDeltaT() const { return m_DeltaTSec; }
+    const std::vector<ReplayPlacement>& getPlacements() const { return m_Placements; }
+
+    // Moves on to the next tick.
+    void advance();
+
+private:
+    void decodeTick();
+    bool readVarint(uint32_t& outValue);
+
+private:
+    std::vector<uint8_t> m_Bytes;
+    size_t m_Pos;
+    bool m_bCorrupt;
+
+    unsigned int m_NumTicks;
+    unsigned int m_TickIndex;
+    float m_DeltaTSec;
+    std::vector<ReplayPlacement> m_Placements;
+
+    // Delta decoding state
+    uint32_t m_SkippedTicks;
+    bool m_bRecordPending;          // we've read a record's skip count, but not the rest
+    uint32_t m_LastDeltaTBits;
+    int m_LastTile;
+};
+
+// Places one side's recorded mobs, on the tick they were placed.
+// NOTE: the reader must be advanced after each Game::tick().
+class ReplayController : public iController
+{
+public:
+    ReplayController(const ReplayReader& reader, bool bNorth);
+
+    virtual void tick(float deltaTSec);
+
+private:
+    const ReplayReader& m_Reader;
+    bool m_bNorth;
+};
@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Sandbox.h"
+
+#include "Log.h"
+#include "Player.h"
+#include "Profiler.h"
+
+Sandbox::Sandbox()
+    : m_Game(NULL, NULL)
+{
+}
+
+Sandbox::~Sandbox()
+{
+}
+
+void Sandbox::restore(const GameSnapshot& snapshot)
+{
+    Log::ScopedMute mute;
+    PROFILE_MUTE();
+    m_Game.restore(snapshot);
+}
+
+void Sandbox::takeSnapshot(GameSnapshot& outSnapshot) const
+{
+    m_Game.takeSnapshot(outSnapshot);
+}
+
+iPlayer::PlacementResult Sandbox::placeMob(bool bNorth, iEntityStats::MobType type, const Vec2& pos)
+{
+    Log::ScopedMute mute;
+    PROFILE_MUTE();
+    return m_Game.getPlayer(bNorth).placeMob(type, pos);
+}
+
+void Sandbox::tick(float deltaTSec)
+{
+    Log::ScopedMute mute;
+    PROFILE_MUTE();
+    m_Game.tick(deltaTSec);
+}
+
+int Sandbox::checkGameOver()
+{
+    return m_Game.checkGameOver();
+}
+
+const iPlayer& Sandbox::getPlayer(bool bNorth) const
+{
+    return m_Game.getPlayer(bNorth);
+}
@@ -0,0 +1,51 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "iSandbox.h"
+
+#include "Game.h"
+
+// A Game with no controllers, for lookahead controllers to play snapshots 
+// forward in.  See iSandbox.h.
+//   Everything the sandbox does is done with logging and profiling muted (on
+// the calling thread), so that imaginary battles don't flood the log or bury
+// the real ticks in the profile.
+class Sandbox : public iSandbox
+{
+public:
+    Sandbox();
+    virtual ~Sandbox();
+
+    virtual void restore(const GameSnapshot& snapshot);
+    virtual void takeSnapshot(GameSnapshot& outSnapshot) const;
+
+    virtual iPlayer::PlacementResult placeMob(bool bNorth, iEntityStats::MobType type, const Vec2& pos);
+    virtual void tick(float deltaTSec);
+    virtual int checkGameOver();
+
+    virtual const iPlayer& getPlayer(bool bNorth) const;
+
+private:
+    Game m_Game;
+};
@@ -0,0 +1,86 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SpatialGrid.h"
+
+#include "EntityStore.h"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid()
+    : m_NumEntities(0)
+{
+}
+
+void SpatialGrid::clear()
+{
+    // NOTE: clear() keeps the capacity of each cell, so once the grid has 
+    // warmed up rebuilding it doesn't allocate.
+    for (std::vector<unsigned int>& cell : m_Cells)
+    {
+        cell.clear();
+    }
+    m_NumEntities = 0;
+}
+
+void SpatialGrid::insert(unsigned int index, const Vec2& pos)
+{
+    m_Cells[cellIndex(toTileX(pos.x), toTileY(pos.y))].push_back(index);
+    ++m_NumEntities;
+}
+
+void SpatialGrid::rebuild(const EntityStore& store)
+{
+    clear();
+
+    const std::vector<Vec2>& positions = store.getPositions();
+    const std::vector<int>& healths = store.getHealths();
+    for (unsigned int i = 0; i < store.size(); ++i)
+    {
+        if (healths[i] > 0)
+        {
+            insert(i, positions[i]);
+        }
+    }
+}
+
+void SpatialGrid::getCellRange(const Vec2& center, float radius,
+                               int& minX, int& minY, int& maxX, int& maxY) const
+{
+    minX = toTileX(center.x - radius);
+    minY = toTileY(center.y - radius);
+    maxX = toTileX(center.x + radius);
+    maxY = toTileY(center.y + radius);
+}
+
+float SpatialGrid::cellDistSqr(int x, int y, const Vec2& pos) const
+{
+    // Entities off the edge of the arena are clamped into the border cells, 
+    // so the border cells extend out to infinity.
+    const float left = (x == 0) ? -FLT_MAX : (float)x;
+    const float right = (x == GAME_GRID_WIDTH - 1) ? FLT_MAX : (float)(x + 1);
+    const float top = (y == 0) ? -FLT_MAX : (float)y;
+    const float bottom = (y == GAME_GRID_HEIGHT - 1) ? FLT_MAX : (float)(y + 1);
+
+    const float dx = std::max(0.f, std::max(left - pos.x, pos.x - right));
+    const float dy = std::max(0.f, std::max(top - pos.y, pos.y - bottom));
+    return (dx * dx) + (dy * dy);
+}
@@ -0,0 +1,68 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Constants.h"
+#include "Vec2.h"
+#include <vector>
+
+class EntityStore;
+
+// A uniform grid over the arena with one cell per tile.  The entities in an
+// EntityStore are bucketed (by slot index) by the tile that holds their 
+// position, so a range query only has to visit the cells near the query point
+// rather than every entity in the game.
+//   The grid doesn't track movement - rebuild it whenever the entities in the
+// store may have moved, or the store has been packed.
+class SpatialGrid
+{
+public:
+    SpatialGrid();
+
+    void clear();
+    void insert(unsigned int index, const Vec2& pos);
+
+    // Clears the grid and inserts every live entity in the store.
+    void rebuild(const EntityStore& store);
+
+    // Gets the (inclusive) range of cells overlapping the box around a circle.
+    void getCellRange(const Vec2& center, float radius, 
+                      int& minX, int& minY, int& maxX, int& maxY) const;
+
+    // The store indices of the entities in a cell
+    const std::vector<unsigned int>& getCell(int x, int y) const { return m_Cells[cellIndex(x, y)]; }
+
+    // The squared distance from pos to the closest point in the cell.  Nothing
+    // in the cell can be closer to pos than this.
+    float cellDistSqr(int x, int y, const Vec2& pos) const;
+
+    unsigned int getNumEntities() const { return m_NumEntities; }
+
+private:
+    // The cells are the field's tiles.
+    static int cellIndex(int x, int y) { return toTileIndex(x, y); }
+
+private:
+    std::vector<unsigned int> m_Cells[GAME_GRID_WIDTH * GAME_GRID_HEIGHT];
+    unsigned int m_NumEntities;
+};
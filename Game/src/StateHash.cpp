@@ -0,0 +1,109 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "StateHash.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+
+static const char ksHashLogMagic[4] = { 'C', 'L', 'S', 'H' };
+
+static void writeLE(std::vector<uint8_t>& bytes, uint64_t value, unsigned int numBytes)
+{
+    for (unsigned int i = 0; i < numBytes; ++i)
+    {
+        bytes.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+static uint64_t readLE(const uint8_t* pBytes, unsigned int numBytes)
+{
+    uint64_t value = 0;
+    for (unsigned int i = 0; i < numBytes; ++i)
+    {
+        value |= (uint64_t)pBytes[i] << (8 * i);
+    }
+    return value;
+}
+
+bool StateHashLog::save(const std::string& path) const
+{
+    std::vector<uint8_t> bytes(ksHashLogMagic, ksHashLogMagic + sizeof(ksHashLogMagic));
+    bytes.reserve(sizeof(ksHashLogMagic) + 4 + 8 * m_Hashes.size());
+    writeLE(bytes, m_Hashes.size(), 4);
+    for (uint64_t hash : m_Hashes)
+    {
+        writeLE(bytes, hash, 8);
+    }
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write((const char*)bytes.data(), bytes.size());
+    return !!file;
+}
+
+bool StateHashLog::load(const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        printf("Couldn't open hash log %s\n", path.c_str());
+        return false;
+    }
+
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t headerSize = sizeof(ksHashLogMagic) + 4;
+    if ((bytes.size() < headerSize) || (memcmp(bytes.data(), ksHashLogMagic, sizeof(ksHashLogMagic)) != 0))
+    {
+        printf("%s is not a hash log\n", path.c_str());
+        return false;
+    }
+
+    const uint64_t numTicks = readLE(bytes.data() + sizeof(ksHashLogMagic), 4);
+    if (bytes.size() != headerSize + 8 * numTicks)
+    {
+        printf("%s is corrupt\n", path.c_str());
+        return false;
+    }
+
+    m_Hashes.resize((size_t)numTicks);
+    for (size_t i = 0; i < m_Hashes.size(); ++i)
+    {
+        m_Hashes[i] = readLE(bytes.data() + headerSize + 8 * i, 8);
+    }
+    return true;
+}
+
+int StateHashLog::findDivergence(const StateHashLog& a, const StateHashLog& b)
+{
+    const size_t numCommon = std::min(a.m_Hashes.size(), b.m_Hashes.size());
+    const std::pair<std::vector<uint64_t>::const_iterator, std::vector<uint64_t>::const_iterator> mismatch =
+        std::mismatch(a.m_Hashes.begin(), a.m_Hashes.begin() + numCommon, b.m_Hashes.begin());
+
+    const int tick = (int)(mismatch.first - a.m_Hashes.begin());
+    if ((tick == (int)numCommon) && (a.m_Hashes.size() == b.m_Hashes.size()))
+    {
+        return -1;
+    }
+    return tick;
+}
@@ -0,0 +1,107 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "Vec2.h"
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// A running hash of the simulation state.  Game::tick() folds every field that
+// the next tick depends on (positions, health, targets, timers, elixir, etc.)
+// into one of these as the very last thing it does, so two runs that are 
+// meant to be identical can be checked tick by tick just by comparing 64 bit
+// numbers.  See StateHashLog for finding where they part ways.
+//   Floats are hashed by their bits, so the hashes only match if the runs are
+// bit-for-bit the same - which is what determinism means here.  This is 
+// 64 bit FNV-1a, fed a 32 bit word at a time.
+class StateHash
+{
+public:
+    StateHash() : m_Hash(14695981039346656037ull) {}
+
+    uint64_t get() const { return m_Hash; }
+
+    void add(uint32_t value)
+    {
+        m_Hash = (m_Hash ^ value) * 1099511628211ull;
+    }
+
+    void add(int value) { add((uint32_t)value); }
+    void add(bool value) { add(value ? 1u : 0u); }
+
+    void add(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        add(bits);
+    }
+
+    void add(const Vec2& v)
+    {
+        add(v.x);
+        add(v.y);
+    }
+
+    void add(const EntityHandle& handle)
+    {
+        add((uint32_t)handle.m_Index);
+        add((uint32_t)handle.m_Generation);
+        add(((uint32_t)handle.m_bNorth << 1) | (uint32_t)handle.m_bBuilding);
+    }
+
+private:
+    uint64_t m_Hash;
+};
+
+// The state hash after each tick of a run, in order.  Saved next to a 
+// recorded match (see MatchRunner), so that replaying the match later - after
+// an optimization, say - can show whether it still plays out the same.
+//   The file is "CLSH", the number of ticks (32 bits) and then the hashes 
+// (64 bits each), all little-endian.
+class StateHashLog
+{
+public:
+    void add(uint64_t hash) { m_Hashes.push_back(hash); }
+    void clear() { m_Hashes.clear(); }
+
+    unsigned int getNumTicks() const { return (unsigned int)m_Hashes.size(); }
+    uint64_t getHash(unsigned int tick) const { return m_Hashes[tick]; }
+
+    // Returns false if the file couldn't be written.
+    bool save(const std::string& path) const;
+
+    // Returns false (and prints why) if the file can't be read or isn't a 
+    // hash log.
+    bool load(const std::string& path);
+
+    // Returns the first tick where the two logs disagree, or -1 if they 
+    // agree throughout.  If one log is a prefix of the other, they disagree
+    // at the first tick that only the longer one has.
+    static int findDivergence(const StateHashLog& a, const StateHashLog& b);
+
+private:
+    std::vector<uint64_t> m_Hashes;
+};
@@ -0,0 +1,311 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TowerVisibility.h"
+
+#include "EntityStore.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <float.h>
+#include <mutex>
+
+static const unsigned int ksNumTiles = GAME_GRID_WIDTH * GAME_GRID_HEIGHT;
+
+// The pairs are unordered (a sight line is blocked both ways or neither), so
+// we only keep the ones with lo <= hi, packed as a triangle.
+static const unsigned int ksNumPairs = (ksNumTiles * (ksNumTiles + 1)) / 2;
+static const unsigned int ksNumWords = (ksNumPairs + 63) / 64;
+
+// The tables are built against the tower grown (for "never blocked") or
+// shrunk (for "always blocked") by this much, so that rounding can't make 
+// them disagree with the exact test.  Sight lines that graze a tower are left
+// to the exact test.
+static const float ksMargin = 0.001f;
+
+static unsigned int pairIndex(unsigned int a, unsigned int b)
+{
+    const unsigned int lo = std::min(a, b);
+    const unsigned int hi = std::max(a, b);
+    return ((hi * (hi + 1)) / 2) + lo;
+}
+
+static bool testBit(const std::vector<uint64_t>& bits, unsigned int i)
+{
+    return (bits[i / 64] & (1ull << (i % 64))) != 0;
+}
+
+static void setBit(std::vector<uint64_t>& bits, unsigned int i)
+{
+    bits[i / 64] |= (1ull << (i % 64));
+}
+
+struct TowerVisibility::Table
+{
+    Vec2 m_Center;
+    float m_Size;
+
+    // Every sight line between the two tiles hits the tower.
+    std::vector<uint64_t> m_Always;
+
+    // Some sight line between the two tiles might hit the tower.  Always set
+    // where m_Always is.
+    std::vector<uint64_t> m_Maybe;
+
+    Table(const Vec2& center, float size);
+};
+
+TowerVisibility::Table::Table(const Vec2& center, float size)
+    : m_Center(center)
+    , m_Size(size)
+    , m_Always(ksNumWords, 0)
+    , m_Maybe(ksNumWords, 0)
+{
+    Occluders inner;
+    inner.addBox(center, size - (2.f * ksMargin));
+
+    const float outerHalfSize = (size / 2.f) + ksMargin;
+    const float outerMinX = center.x - outerHalfSize;
+    const float outerMinY = center.y - outerHalfSize;
+    const float outerMaxX = center.x + outerHalfSize;
+    const float outerMaxY = center.y + outerHalfSize;
+
+    for (unsigned int hi = 0; hi < ksNumTiles; ++hi)
+    {
+        const float hiX = (float)(hi % GAME_GRID_WIDTH);
+        const float hiY = (float)(hi / GAME_GRID_WIDTH);
+
+        for (unsigned int lo = 0; lo <= hi; ++lo)
+        {
+            const float loX = (float)(lo % GAME_GRID_WIDTH);
+            const float loY = (float)(lo / GAME_GRID_WIDTH);
+
+            // Every sight line between the tiles lies in the convex hull of 
+            // their corners, so if that misses the tower then none of them 
+            // can hit it.  This is a separating axis test.  First the x and y
+            // axes (i.e. the box around both tiles),
+            if ((std::max(loX, hiX) + 1.f < outerMinX) || (std::min(loX, hiX) > outerMaxX) ||
+                (std::max(loY, hiY) + 1.f < outerMinY) || (std::min(loY, hiY) > outerMaxY))
+            {
+                continue;
+            }
+
+            const Vec2 corners[8] =
+            {
+                Vec2(loX, loY), Vec2(loX + 1.f, loY), Vec2(loX, loY + 1.f), Vec2(loX + 1.f, loY + 1.f),
+                Vec2(hiX, hiY), Vec2(hiX + 1.f, hiY), Vec2(hiX, hiY + 1.f), Vec2(hiX + 1.f, hiY + 1.f),
+            };
+
+            // ... then the normals of the lines from one tile's corners to the
+            // other's, which include all of the hull's slanted edges.
+            bool bSeparated = false;
+            for (int i = 0; (i < 4) && !bSeparated; ++i)
+            {
+                for (int j = 4; (j < 8) && !bSeparated; ++j)
+                {
+                    const float normalX = corners[i].y - corners[j].y;
+                    const float normalY = corners[j].x - corners[i].x;
+                    if ((normalX == 0.f) && (normalY == 0.f))
+                    {
+                        continue;
+                    }
+
+                    float hullMin = FLT_MAX;
+                    float hullMax = -FLT_MAX;
+                    for (const Vec2& corner : corners)
+                    {
+                        const float d = (corner.x * normalX) + (corner.y * normalY);
+                        hullMin = std::min(hullMin, d);
+                        hullMax = std::max(hullMax, d);
+                    }
+
+                    const float towerMid = (center.x * normalX) + (center.y * normalY);
+                    const float towerRadius = outerHalfSize * (std::fabs(normalX) + std::fabs(normalY));
+                    bSeparated = (hullMax < towerMid - towerRadius) || (hullMin > towerMid + towerRadius);
+                }
+            }
+
+            if (bSeparated)
+            {
+                continue;
+            }
+
+            const unsigned int pair = pairIndex(lo, hi);
+            setBit(m_Maybe, pair);
+
+            // If a sight line misses the tower, there's a line that separates
+            // them, and on its side there's a corner of each tile - so the 
+            // line between those corners misses too.  So if all of the corner
+            // to corner lines hit the tower, every sight line does.
+            bool bAllBlocked = true;
+            for (int i = 0; (i < 4) && bAllBlocked; ++i)
+            {
+                for (int j = 4; (j < 8) && bAllBlocked; ++j)
+                {
+                    bAllBlocked = inner.isSegmentBlocked_Scalar(corners[i], corners[j]);
+                }
+            }
+
+            if (bAllBlocked)
+            {
+                setBit(m_Always, pair);
+            }
+        }
+    }
+}
+
+TowerVisibility::TowerVisibility()
+    : m_AlwaysBlocked(ksNumWords, 0)
+    , m_MaybeBlocked(ksNumWords, 0)
+{
+}
+
+const TowerVisibility::Table& TowerVisibility::getTable(const Vec2& center, float size)
+{
+    // The tables live until the program exits.  Building one takes a few 
+    // milliseconds, so games on other threads wait for it rather than 
+    // building their own.
+    struct TableCache
+    {
+        std::mutex m_Mutex;
+        std::vector<Table*> m_Tables;
+
+        ~TableCache()
+        {
+            for (Table* pTable : m_Tables)
+            {
+                delete pTable;
+            }
+        }
+    };
+    static TableCache s_Cache;
+
+    std::lock_guard<std::mutex> lock(s_Cache.m_Mutex);
+    for (const Table* pTable : s_Cache.m_Tables)
+    {
+        if ((pTable->m_Center.x == center.x) && (pTable->m_Center.y == center.y) && (pTable->m_Size == size))
+        {
+            return *pTable;
+        }
+    }
+
+    Table* pTable = new Table(center, size);
+    s_Cache.m_Tables.push_back(pTable);
+    return *pTable;
+}
+
+void TowerVisibility::addTower(const Vec2& center, float size)
+{
+    Tower tower;
+    tower.m_pTable = &getTable(center, size);
+    tower.m_Center = center;
+    tower.m_Size = size;
+    tower.m_bAlive = true;
+    m_Towers.push_back(tower);
+
+    rebuildWords(*tower.m_pTable);
+    rebuildLiveTowers();
+}
+
+void TowerVisibility::update(const EntityStore& buildings)
+{
+    assert(buildings.size() == m_Towers.size());
+
+    const std::vector<int>& healths = buildings.getHealths();
+    bool bChanged = false;
+    for (unsigned int i = 0; i < m_Towers.size(); ++i)
+    {
+        Tower& tower = m_Towers[i];
+        const bool bAlive = healths[i] > 0;
+        if (bAlive != tower.m_bAlive)
+        {
+            tower.m_bAlive = bAlive;
+            rebuildWords(*tower.m_pTable);
+            bChanged = true;
+        }
+    }
+
+    if (bChanged)
+    {
+        rebuildLiveTowers();
+    }
+}
+
+bool TowerVisibility::isSegmentBlocked(const Vec2& start, const Vec2& end) const
+{
+    // Positions off the field aren't in any tile, so the tables can't answer 
+    // for them.
+    if (isOnField(start) && isOnField(end))
+    {
+        const unsigned int startTile = (unsigned int)toTileIndex(start);
+        const unsigned int endTile = (unsigned int)toTileIndex(end);
+        const unsigned int pair = pairIndex(startTile, endTile);
+        if (testBit(m_AlwaysBlocked, pair))
+        {
+            return true;
+        }
+        if (!testBit(m_MaybeBlocked, pair))
+        {
+            return false;
+        }
+    }
+
+    return m_LiveTowers.isSegmentBlocked(start, end);
+}
+
+void TowerVisibility::rebuildWords(const Table& table)
+{
+    for (unsigned int w = 0; w < ksNumWords; ++w)
+    {
+        // m_Always is a subset of m_Maybe, so this covers both.
+        if (table.m_Maybe[w] == 0)
+        {
+            continue;
+        }
+
+        uint64_t always = 0;
+        uint64_t maybe = 0;
+        for (const Tower& tower : m_Towers)
+        {
+            if (tower.m_bAlive)
+            {
+                always |= tower.m_pTable->m_Always[w];
+                maybe |= tower.m_pTable->m_Maybe[w];
+            }
+        }
+        m_AlwaysBlocked[w] = always;
+        m_MaybeBlocked[w] = maybe;
+    }
+}
+
+void TowerVisibility::rebuildLiveTowers()
+{
+    m_LiveTowers.clear();
+    for (const Tower& tower : m_Towers)
+    {
+        if (tower.m_bAlive)
+        {
+            m_LiveTowers.addBox(tower.m_Center, tower.m_Size);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Constants.h"
+#include "Occluders.h"
+#include "Vec2.h"
+#include <stdint.h>
+#include <vector>
+
+class EntityStore;
+
+// Which pairs of tiles a player's towers block the line of sight between.
+//   Towers never move, so for most pairs of tiles the answer is the same for
+// any two points in them: either every sight line between the two tiles hits
+// the tower, or none of them does.  Those answers are worked out once per 
+// tower, the first time a game is built (the tables are shared by every game,
+// since the towers are always in the same places), and kept as bitsets with
+// one bit per pair of tiles.  Only the pairs in between - where it depends on
+// where exactly in the tiles the two ends are - need the exact test, so the 
+// only blockers that most sight lines have to be tested against are the 
+// Giants.
+//   Each player keeps the union of its live towers' tables.  When a tower 
+// dies (or comes back, when a snapshot is restored) only the words of the 
+// union that the tower has bits in are rebuilt.
+class TowerVisibility
+{
+public:
+    TowerVisibility();
+
+    // Adds a tower.  Call this for each building, in store order, as they're
+    // built.  NOTE: the towers must never move.
+    void addTower(const Vec2& center, float size);
+
+    // Catches up with any towers that have died or come back to life since 
+    // the last update.  Does next to nothing if none have.
+    void update(const EntityStore& buildings);
+
+    // Does the segment from start to end pass through (or touch) any live 
+    // tower?  Always gives the same answer as the exact test in Occluders.
+    bool isSegmentBlocked(const Vec2& start, const Vec2& end) const;
+
+    // The boxes of the live towers.  Used for the pairs of tiles that the 
+    // tables can't answer, and for ends off the field.
+    const Occluders& getLiveTowers() const { return m_LiveTowers; }
+
+private:
+    // One tower's bits.  See TowerVisibility.cpp.
+    struct Table;
+    static const Table& getTable(const Vec2& center, float size);
+
+    // Rebuilds the words of the union that the table has bits in.
+    void rebuildWords(const Table& table);
+    void rebuildLiveTowers();
+
+private:
+    struct Tower
+    {
+        const Table* m_pTable;          // shared, not owned
+        Vec2 m_Center;
+        float m_Size;
+        bool m_bAlive;
+    };
+
+    std::vector<Tower> m_Towers;
+
+    // The union of the live towers' tables: pairs where every sight line is
+    // blocked, and pairs where some sight line might be.
+    std::vector<uint64_t> m_AlwaysBlocked;
+    std::vector<uint64_t> m_MaybeBlocked;
+
+    Occluders m_LiveTowers;
+};
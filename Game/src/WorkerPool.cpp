@@ -0,0 +1,133 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+// Each thread hands out this many chunks' worth of the loop, so that a thread
+// that gets the slow items doesn't hold everybody else up for long.
+static const unsigned int ksChunksPerThread = 8;
+
+thread_local const WorkerPool* WorkerPool::s_pCurrentPool = NULL;
+thread_local unsigned int WorkerPool::s_CurrentThread = 0;
+
+WorkerPool::WorkerPool(unsigned int numThreads)
+    : m_Generation(0)
+    , m_NumWorking(0)
+    , m_bQuit(false)
+    , m_pFunc(NULL)
+    , m_pContext(NULL)
+    , m_Count(0)
+    , m_ChunkSize(1)
+    , m_NextIndex(0)
+{
+    for (unsigned int thread = 1; thread < std::max(numThreads, 1u); ++thread)
+    {
+        m_Workers.push_back(std::thread([this, thread]() { workerMain(thread); }));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bQuit = true;
+    }
+    m_WorkReady.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(unsigned int count, RangeFunc pFunc, const void* pContext)
+{
+    const unsigned int chunkSize = std::max(count / (getNumThreads() * ksChunksPerThread), 1u);
+
+    // Not worth waking anybody up for.
+    if (m_Workers.empty() || (count <= chunkSize))
+    {
+        pFunc(pContext, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_pFunc = pFunc;
+        m_pContext = pContext;
+        m_Count = count;
+        m_ChunkSize = chunkSize;
+        m_NextIndex.store(0, std::memory_order_relaxed);
+        m_NumWorking = (unsigned int)m_Workers.size();
+        ++m_Generation;
+    }
+    m_WorkReady.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkDone.wait(lock, [this]() { return m_NumWorking == 0; });
+}
+
+void WorkerPool::workerMain(unsigned int thread)
+{
+    s_pCurrentPool = this;
+    s_CurrentThread = thread;
+
+    uint64_t lastGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [this, lastGeneration]() { return m_bQuit || (m_Generation != lastGeneration); });
+            if (m_bQuit)
+            {
+                return;
+            }
+            lastGeneration = m_Generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_NumWorking == 0)
+        {
+            m_WorkDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runChunks()
+{
+    while (true)
+    {
+        const unsigned int begin = m_NextIndex.fetch_add(m_ChunkSize, std::memory_order_relaxed);
+        if (begin >= m_Count)
+        {
+            return;
+        }
+
+        m_pFunc(m_pContext, begin, std::min(begin + m_ChunkSize, m_Count));
+    }
+}
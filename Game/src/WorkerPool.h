@@ -0,0 +1,101 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads for splitting a loop across cores - see Game's 
+// decide phase.  The thread that calls parallelFor() does its share of the 
+// work too, so a pool of n threads starts n - 1 workers.  
+//   Handing out a loop doesn't allocate, and the workers sleep in between.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned int numThreads);
+    ~WorkerPool();
+
+    unsigned int getNumThreads() const { return (unsigned int)m_Workers.size() + 1; }
+
+    // Which of our threads is calling: 1 and up for the workers, and 0 for 
+    // the thread that called parallelFor() (or any thread that isn't ours).
+    unsigned int getCurrentThread() const { return (s_pCurrentPool == this) ? s_CurrentThread : 0; }
+
+    // Calls func(i) for every i in [0, count), spread over our threads, and 
+    // returns when they've all been done.  The calls may happen in any order,
+    // so they mustn't depend on each other.  NOTE: not reentrant.
+    template <class Func>
+    void parallelFor(unsigned int count, const Func& func)
+    {
+        run(count, &callRange<Func>, &func);
+    }
+
+private:
+    typedef void (*RangeFunc)(const void* pContext, unsigned int begin, unsigned int end);
+
+    template <class Func>
+    static void callRange(const void* pContext, unsigned int begin, unsigned int end)
+    {
+        const Func& func = *static_cast<const Func*>(pContext);
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            func(i);
+        }
+    }
+
+    void run(unsigned int count, RangeFunc pFunc, const void* pContext);
+    void workerMain(unsigned int thread);
+
+    // Claims chunks of the current loop, and runs them, until there are none
+    // left.
+    void runChunks();
+
+private:
+    static thread_local const WorkerPool* s_pCurrentPool;
+    static thread_local unsigned int s_CurrentThread;
+
+    std::vector<std::thread> m_Workers;
+
+    std::mutex m_Mutex;                     // guards everything below but m_NextIndex
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    uint64_t m_Generation;                  // bumped for each loop
+    unsigned int m_NumWorking;              // workers still on the current loop
+    bool m_bQuit;
+
+    // The current loop
+    RangeFunc m_pFunc;
+    const void* m_pContext;
+    unsigned int m_Count;
+    unsigned int m_ChunkSize;
+    std::atomic<unsigned int> m_NextIndex;
+
+private:
+    // DELIBERATELY UNDEFINED
+    WorkerPool(const WorkerPool& rhs);
+    WorkerPool& operator=(const WorkerPool& rhs);
+};
@@ -29,6 +29,32 @@ const int PIXELS_PER_METER = 30; // The width of a game grid tile
 const int GAME_GRID_WIDTH = 18; // How many tiles wide the game grid is. Should be an even number
 const int GAME_GRID_HEIGHT = 32; // How many tiles tall the game grid is. 
 
+// Converting world positions to tiles.  Tiles are 1 unit wide, and tile (0, 0)
+// starts at the world origin.  Positions off the field are clamped into the 
+// border tiles.  Clamp before converting, so that huge values can't overflow 
+// the int.
+inline int toTileX(float x)
+{
+    const float maxX = (float)(GAME_GRID_WIDTH - 1);
+    return (int)((x < 0.f) ? 0.f : ((x > maxX) ? maxX : x));
+}
+
+inline int toTileY(float y)
+{
+    const float maxY = (float)(GAME_GRID_HEIGHT - 1);
+    return (int)((y < 0.f) ? 0.f : ((y > maxY) ? maxY : y));
+}
+
+inline int toTileIndex(int x, int y) { return (y * GAME_GRID_WIDTH) + x; }
+inline int toTileIndex(const Vec2& pos) { return toTileIndex(toTileX(pos.x), toTileY(pos.y)); }
+
+// Is the position in a tile, without clamping?  (NaNs aren't.)
+inline bool isOnField(const Vec2& pos)
+{
+    return (pos.x >= 0.f) && (pos.x < (float)GAME_GRID_WIDTH) &&
+           (pos.y >= 0.f) && (pos.y < (float)GAME_GRID_HEIGHT);
+}
+
 const int UI_WIDTH = 10; // The width of the UI section to the right of the play area in meters
 const int UI_HEIGHT = GAME_GRID_HEIGHT; // The height of the UI Section is the height of the play area
 
@@ -58,20 +84,23 @@ const float NorthKingY = 3.f;
 const float SouthPrincessY = (float)GAME_GRID_HEIGHT - NorthPrincessY;
 const float SouthKingY = (float)GAME_GRID_HEIGHT - NorthKingY;
 
-// Waypoints
-const float WAYPOINT_LEFT_X = LEFT_BRIDGE_CENTER_X;
-const float WAYPOINT_RIGHT_X = RIGHT_BRIDGE_CENTER_X;
-const float WAYPOINT_Y_INCREMENT = 2.f;
-
 // Tick limitations
 const float TICK_MIN = 0.05f;
 const float TICK_MAX = 0.2f;
 
+// Game loop
+const float DEFAULT_TICK_RATE = 1.f / TICK_MIN; // Simulation ticks per second (override with -tickrate)
+const double MAX_FRAME_WAIT = 0.01; // How long (in seconds) the render thread waits for a new frame before checking for events again
+const double MAX_TICK_BACKLOG = 1.0; // How far (in seconds) the simulation can fall behind before we skip ahead
+
 // Elixir
 
 const float STARTING_ELIXIR = 8.f;
 const float ELIXIR_PER_SECOND = 0.33333f;
 const float MAX_ELIXIR = 10.01f; // a little bit more than 10, to avoid float error
 
+// Mobs
+const int MAX_MOBS_PER_PLAYER = 8192; // How many mobs each player can have alive at once (the size of its mob pool)
+
 
 
@@ -0,0 +1,64 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <limits.h>
+
+// A weak reference to an entity.  Mobs are recycled through a pool when they
+// die, so rather than holding an Entity* (which would dangle, or worse, point
+// at whichever mob reused the slot) we hold the slot and the mob's generation.
+// The pool gives every mob a new generation, so a handle to a mob that has 
+// been freed simply fails to resolve, even once its slot is reused.  Use 
+// Game::getEntity() to turn a handle back into an Entity*.
+//   Buildings are never freed, so their handles are just their index in the
+// owning player's building store, and their generation is always 0.
+struct EntityHandle
+{
+    EntityHandle()
+        : m_Index(UINT_MAX)
+        , m_Generation(0)
+        , m_bNorth(false)
+        , m_bBuilding(false)
+    {}
+
+    EntityHandle(bool bNorth, bool bBuilding, unsigned int index, unsigned int generation)
+        : m_Index(index)
+        , m_Generation(generation)
+        , m_bNorth(bNorth)
+        , m_bBuilding(bBuilding)
+    {}
+
+    bool isNull() const { return m_Index == UINT_MAX; }
+
+    bool operator==(const EntityHandle& rhs) const
+    {
+        return (m_Index == rhs.m_Index) && (m_Generation == rhs.m_Generation) &&
+               (m_bNorth == rhs.m_bNorth) && (m_bBuilding == rhs.m_bBuilding);
+    }
+    bool operator!=(const EntityHandle& rhs) const { return !(*this == rhs); }
+
+    unsigned int m_Index;           // slot in the mob pool (or building store)
+    unsigned int m_Generation;      // which mob in that slot we refer to
+    bool m_bNorth;                  // which player owns the entity
+    bool m_bBuilding;
+};
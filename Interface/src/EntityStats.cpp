@@ -22,128 +22,67 @@
 
 #include "EntityStats.h"
 
+#include "StatsTables.h"
 #include <assert.h>
-#include <unordered_map>
+#include <stddef.h>
 
-class EntityStats_Rogue : public iEntityStats_Mob
+// These just read from the tables in StatsTables.h, so that controllers can 
+// keep using the iEntityStats interface.
+class EntityStats_MobRow : public iEntityStats_Mob
 {
 public:
-    virtual MobType getMobType() const { return Rogue; }
-    virtual TargetType getType() const { return Mob; }
-    virtual float getElixirCost() const { return 2.f; }
-    virtual int getMaxHealth() const { return 500; }
-    virtual float getSpeed() const { return 5.f; }
-    virtual float getSize() const { return 0.4f; }
-    virtual float getMass() const { return 2.f; }
-    virtual TargetType getTargetType() const { return Mob; }
-    virtual float getAttackRange() const { return 0.2f; }
-    virtual DamageType getDamageType() const { return Melee; }
-    virtual int getDamage() const { return 100; }
-    virtual float getAttackTime() const { return 0.5f; }
-    virtual float getSightRadius() const { return 10.f; }
-    virtual const char* getName() const { return "Rogue"; }
-    virtual const char* getDisplayLetter() const { return "R"; }
-
-    virtual bool canSpringAttack() const { return true; }
-    virtual float getSpringRange() const { return 2.5; }
-    virtual float getSpringSpeed() const { return 15; }
-    virtual int getSpringAttackDamage() const { return 1000; }
-    virtual float perferGiantRange() const { return 2.f; }
-    virtual float getHideDistance() const { return 0.5f; }
-    virtual float timeToHide() const { return 2.f; }
-};
-
-class EntityStats_Swordsman : public iEntityStats_Mob
-{
-public:
-    virtual TargetType getType() const { return Mob; }
-    virtual MobType getMobType() const { return Swordsman; }
-    virtual float getElixirCost() const { return 3.f; }
-    virtual int getMaxHealth() const { return 1452; }
-    virtual float getSpeed() const { return 3.f; }
-    virtual float getSize() const { return 0.5f; }
-    virtual float getMass() const { return 3.f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual float getAttackRange() const { return 0.2f; }
-    virtual DamageType getDamageType() const { return Melee; }
-    virtual int getDamage() const { return 167; }
-    virtual float getAttackTime() const { return 1.2f; }
-    virtual float getSightRadius() const { return 4.f; }
-    virtual const char* getName() const { return "Swordsman"; }
-    virtual const char* getDisplayLetter() const { return "S"; }
+    explicit EntityStats_MobRow(const EntityStatsData& data) : m_Data(data) {}
+
+    virtual MobType getMobType() const { return m_Data.m_MobType; }
+    virtual TargetType getType() const { return m_Data.m_Type; }
+    virtual float getElixirCost() const { return m_Data.m_ElixirCost; }
+    virtual int getMaxHealth() const { return m_Data.m_MaxHealth; }
+    virtual float getSpeed() const { return m_Data.m_Speed; }
+    virtual float getSize() const { return m_Data.m_Size; }
+    virtual float getMass() const { return m_Data.m_Mass; }
+    virtual TargetType getTargetType() const { return m_Data.m_TargetType; }
+    virtual float getAttackRange() const { return m_Data.m_AttackRange; }
+    virtual DamageType getDamageType() const { return m_Data.m_DamageType; }
+    virtual int getDamage() const { return m_Data.m_Damage; }
+    virtual float getAttackTime() const { return m_Data.m_AttackTime; }
+    virtual float getSightRadius() const { return m_Data.m_SightRadius; }
+    virtual const char* getName() const { return m_Data.m_Name; }
+    virtual const char* getDisplayLetter() const { return m_Data.m_DisplayLetter; }
+
+    virtual bool canSpringAttack() const { return m_Data.m_bCanSpringAttack; }
+    virtual float getSpringRange() const { assert(isRogue()); return m_Data.m_SpringRange; }
+    virtual float getSpringSpeed() const { assert(isRogue()); return m_Data.m_SpringSpeed; }
+    virtual int getSpringAttackDamage() const { assert(isRogue()); return m_Data.m_SpringAttackDamage; }
+    virtual float perferGiantRange() const { assert(isRogue()); return m_Data.m_PreferGiantRange; }
+    virtual float getHideDistance() const { assert(isRogue()); return m_Data.m_HideDistance; }
+    virtual float timeToHide() const { assert(isRogue()); return m_Data.m_TimeToHide; }
+
+private:
+    bool isRogue() const { return m_Data.m_MobType == Rogue; }
+
+private:
+    const EntityStatsData& m_Data;
 };
 
-class EntityStats_Archer : public iEntityStats_Mob
+class EntityStats_BuildingRow : public iEntityStats_Building
 {
 public:
-    virtual TargetType getType() const { return Mob; }
-    virtual MobType getMobType() const { return Archer; }
-    virtual float getElixirCost() const { return 2.f; }
-    virtual int getMaxHealth() const { return 216; }
-    virtual float getSpeed() const { return 5.0f; }
-    virtual float getSize() const { return 0.4f; }
-    virtual float getMass() const { return 2.f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual float getAttackRange() const { return 6.5f; }
-    virtual DamageType getDamageType() const { return Ranged; }
-    virtual int getDamage() const { return 100; }
-    virtual float getAttackTime() const { return 0.7f; }
-    virtual float getSightRadius() const { return 8.f; }
-    virtual const char* getName() const { return "Archer"; }
-    virtual const char* getDisplayLetter() const { return "A"; }
-};
-
-class EntityStats_Giant : public iEntityStats_Mob
-{
-public:
-    virtual TargetType getType() const { return Mob; }
-    virtual MobType getMobType() const { return Giant; }
-    virtual float getElixirCost() const { return 5.f; }
-    virtual int getMaxHealth() const { return 3275; }
-    virtual float getSpeed() const { return 2.f; }
-    virtual float getSize() const { return 0.9f; }
-    virtual float getMass() const { return 8.f; }
-    virtual TargetType getTargetType() const { return Building; }
-    virtual float getAttackRange() const { return .5f; }
-    virtual DamageType getDamageType() const { return Melee; }
-    virtual int getDamage() const { return 211; }
-    virtual float getAttackTime() const { return 1.5f; }
-    virtual float getSightRadius() const { return 3.f; }
-    virtual const char* getName() const { return "Giant"; }
-    virtual const char* getDisplayLetter() const { return "G"; }
-};
-
-class EntityStats_Princess : public iEntityStats_Building
-{
-public:
-    virtual TargetType getType() const { return Building; }
-    virtual BuildingType getBuildingType() const { return Princess; }
-    virtual int getMaxHealth() const { return 2534; }
-    virtual float getSize() const { return 2.5f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual int getDamage() const { return 90; }
-    virtual float getAttackRange() const { return 7.5f; }
-    virtual float getAttackTime() const { return 0.8f; }
-    virtual float getSightRadius() const { return 8.f; }
-    virtual const char* getName() const { return "Princess Tower"; }
-    virtual const char* getDisplayLetter() const { return "P"; }
-};
-
-class EntityStats_King : public iEntityStats_Building
-{
-public:
-
-    virtual TargetType getType() const { return Building; }
-    virtual BuildingType getBuildingType() const { return King; }
-    virtual int getMaxHealth() const { return 4008; }
-    virtual float getSize() const { return 3.5f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual int getDamage() const { return 90; }
-    virtual float getAttackRange() const { return 7.f; }
-    virtual float getAttackTime() const { return 1.f; }
-    virtual float getSightRadius() const { return 8.f; }
-    virtual const char* getName() const { return "King Tower"; }
-    virtual const char* getDisplayLetter() const { return "K"; }
+    explicit EntityStats_BuildingRow(const EntityStatsData& data) : m_Data(data) {}
+
+    virtual TargetType getType() const { return m_Data.m_Type; }
+    virtual BuildingType getBuildingType() const { return m_Data.m_BuildingType; }
+    virtual int getMaxHealth() const { return m_Data.m_MaxHealth; }
+    virtual float getSize() const { return m_Data.m_Size; }
+    virtual TargetType getTargetType() const { return m_Data.m_TargetType; }
+    virtual int getDamage() const { return m_Data.m_Damage; }
+    virtual float getAttackRange() const { return m_Data.m_AttackRange; }
+    virtual float getAttackTime() const { return m_Data.m_AttackTime; }
+    virtual float getSightRadius() const { return m_Data.m_SightRadius; }
+    virtual const char* getName() const { return m_Data.m_Name; }
+    virtual const char* getDisplayLetter() const { return m_Data.m_DisplayLetter; }
+
+private:
+    const EntityStatsData& m_Data;
 };
 
 class EntityStats_Invalid : public iEntityStats_Mob
@@ -170,23 +109,18 @@ public:
 
 const iEntityStats& iEntityStats::getStats(MobType t)
 {
-    // NOTE: This vector must be in synch with the MobType enum (in the .h)
-    static std::vector<const iEntityStats*> sStats = { 
-        new EntityStats_Swordsman, 
-        new EntityStats_Archer,
-        new EntityStats_Giant,
-        new EntityStats_Rogue
+    // NOTE: This array must be in synch with the MobType enum (in the .h)
+    static const EntityStats_MobRow ksStats[numMobTypes] = {
+        EntityStats_MobRow(MOB_STATS[Swordsman]),
+        EntityStats_MobRow(MOB_STATS[Archer]),
+        EntityStats_MobRow(MOB_STATS[Giant]),
+        EntityStats_MobRow(MOB_STATS[Rogue])
     };
 
-    // If any of these fail, then your vector (above) is out of synch with the 
-    //  MobType enum (in the .h)... and bad things may ensue!
-    assert(sStats.size() == numMobTypes);
-    assert(!!sStats[t]);
-    assert(sStats[t]->getMobType() == t);
-
-    if ((size_t)t < sStats.size())
+    if ((size_t)t < numMobTypes)
     {
-        return *sStats[t];
+        assert(ksStats[t].getMobType() == t);
+        return ksStats[t];
     }
 
     static const EntityStats_Invalid ksInvalidStats;
@@ -196,24 +130,18 @@ const iEntityStats& iEntityStats::getStats(MobType t)
 
 const iEntityStats& iEntityStats::getBuildingStats(BuildingType t)
 {
-    // NOTE: This vector must be in synch with the MobType enum (in the .h)
-    static std::vector<const iEntityStats*> sStats = {
-        new EntityStats_Princess,
-        new EntityStats_King
+    // NOTE: This array must be in synch with the BuildingType enum (in the .h)
+    static const EntityStats_BuildingRow ksStats[numBuildingTypes] = {
+        EntityStats_BuildingRow(BUILDING_STATS[Princess]),
+        EntityStats_BuildingRow(BUILDING_STATS[King])
     };
 
-    // If any of these fail, then your vector (above) is out of synch with the 
-    //  MobType enum (in the .h)... and bad things may ensue!
-    assert(sStats.size() == numBuildingTypes);
-    assert(!!sStats[t]);
-    assert(sStats[t]->getBuildingType() == t);
-
-    if ((size_t)t < sStats.size())
+    if ((size_t)t < numBuildingTypes)
     {
-        return *sStats[t];
+        assert(ksStats[t].getBuildingType() == t);
+        return ksStats[t];
     }
 
     static const EntityStats_Invalid ksInvalidStats;
     return ksInvalidStats;
 }
-
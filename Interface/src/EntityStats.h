@@ -24,7 +24,7 @@
 
 // Final Project: The interfaces in this file let your AI determine what types 
 // of units exist, and what the characteristics are for each one.  The actual
-// values are in EntityStats.cpp. 
+// values are in StatsTables.h. 
 
 #include <assert.h>
 #include <limits>
@@ -33,7 +33,7 @@
 class iEntityStats
 {
 public:
-    // NOTE: This enum must be in synch with the vector in iEntityStats::getStats()
+    // NOTE: This enum must be in synch with MOB_STATS (in StatsTables.h)
     enum MobType
     {
         Swordsman,
@@ -46,7 +46,7 @@ public:
         InvalidMobType
     };
 
-    // NOTE: This enum must be in synch with the vector in iEntityStats::getBuildingStats()
+    // NOTE: This enum must be in synch with BUILDING_STATS (in StatsTables.h)
     enum BuildingType
     {
         Princess,
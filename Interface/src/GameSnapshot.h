@@ -0,0 +1,94 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "Vec2.h"
+#include <vector>
+
+// Final Project: A snapshot is a copy of the complete state of a game - both 
+// players, all of their entities, their elixir and every timer - which can be
+// restored into an iSandbox and simulated forward.  Use iPlayer::takeSnapshot()
+// to get one, and iPlayer::createSandbox() to get something to play it in.
+//   Everything is plain data in one flat array, so copying a snapshot is a 
+// single allocation and a straight copy, and you can afford to make lots.
+// You can read it too, but treat it as read-only - the layout is for the 
+// game's benefit, and restoring a snapshot you've edited isn't supported.
+
+// The state of one entity.  Handles (our own, our target's, etc.) are stored
+// as-is, so they resolve to the same entities once the snapshot is restored.
+struct EntitySnapshot
+{
+    EntityHandle m_Handle;
+    int m_Id;
+    int m_StatsIndex;               // a MobType or BuildingType
+    Vec2 m_Pos;
+    int m_Health;
+    EntityHandle m_Target;          // null if we had no (live) target
+    float m_TimeSinceAttack;
+    bool m_bHidden;
+    bool m_bTargetLock;
+    bool m_bInSpringAttackRange;
+
+    // Mob state (left at the defaults for buildings).
+    float m_TimeHiding;
+    bool m_bFollowingGiant;
+    bool m_bFollowingBuilding;
+    EntityHandle m_FriendlyGiant;
+    EntityHandle m_FriendlyBuilding;
+};
+
+struct PlayerSnapshot
+{
+    float m_Elixir;
+
+    // Our entities are m_NumBuildings buildings and then m_NumMobs mobs, 
+    // starting at m_FirstEntity in GameSnapshot::m_Entities.  The mobs are in
+    // the order the player ticks them.
+    unsigned int m_FirstEntity;
+    unsigned int m_NumBuildings;
+    unsigned int m_NumMobs;
+
+    // The generation our next new mob will get, so that it gets the same
+    // handle as it would have in the game the snapshot was taken from.
+    unsigned int m_NextMobGeneration;
+};
+
+struct GameSnapshot
+{
+    GameSnapshot()
+        : m_GameOverState(0)
+        , m_NextEntityId(0)
+    {
+        m_Players[0] = m_Players[1] = PlayerSnapshot();
+    }
+
+    const PlayerSnapshot& getPlayer(bool bNorth) const { return m_Players[bNorth ? 0 : 1]; }
+    PlayerSnapshot& getPlayer(bool bNorth) { return m_Players[bNorth ? 0 : 1]; }
+
+    PlayerSnapshot m_Players[2];            // North, then South
+    std::vector<EntitySnapshot> m_Entities;
+
+    int m_GameOverState;
+    int m_NextEntityId;
+};
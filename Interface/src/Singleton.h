@@ -43,7 +43,15 @@ protected:
         s_Obj = (T*)this; 
     }
 
-    virtual ~Singleton() {}
+    // Clear the instance so that a new one can be created later (e.g. when
+    // running several headless matches back to back).
+    virtual ~Singleton() 
+    {
+        if (s_Obj == this)
+        {
+            s_Obj = NULL;
+        }
+    }
 
 public:
     static T& get() 
@@ -0,0 +1,141 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// The stats for every type of mob and building, as compile-time tables of 
+// plain data indexed by MobType and BuildingType.  The game reads these 
+// directly in its inner loops (targeting, hiding, movement, collision), so a
+// stat read is just a load rather than a virtual call.  The iEntityStats
+// interface (which is what the controllers use) reads from these tables too,
+// so this is the one place to change a stat.
+
+#include "EntityStats.h"
+#include <float.h>
+
+struct EntityStatsData
+{
+    iEntityStats::TargetType m_Type;            // Mob or Building
+    iEntityStats::MobType m_MobType;            // InvalidMobType for buildings
+    iEntityStats::BuildingType m_BuildingType;  // InvalidBuildingType for mobs
+
+    float m_ElixirCost;
+    int m_MaxHealth;
+    float m_Speed;
+    float m_Size;
+    float m_Mass;
+    iEntityStats::TargetType m_TargetType;
+    float m_AttackRange;
+    iEntityStats::DamageType m_DamageType;
+    int m_Damage;
+    float m_AttackTime;
+    float m_SightRadius;
+
+    const char* m_Name;
+    const char* m_DisplayLetter;
+
+    // Special values for the Rogue.  Only meaningful if m_bCanSpringAttack.
+    bool m_bCanSpringAttack;
+    float m_SpringRange;
+    float m_SpringSpeed;
+    int m_SpringAttackDamage;
+    float m_PreferGiantRange;
+    float m_HideDistance;
+    float m_TimeToHide;
+};
+
+// NOTE: The rows must be in the same order as the MobType enum.
+constexpr EntityStatsData MOB_STATS[iEntityStats::numMobTypes] =
+{
+    // type, mob type, building type,
+    // cost, health, speed, size, mass, target type, range, damage type, damage, attack time, sight,
+    // name, letter,
+    // spring attack?, spring range, spring speed, spring damage, prefer Giant range, hide distance, time to hide
+    {
+        iEntityStats::Mob, iEntityStats::Swordsman, iEntityStats::InvalidBuildingType,
+        3.f, 1452, 3.f, 0.5f, 3.f, iEntityStats::Any, 0.2f, iEntityStats::Melee, 167, 1.2f, 4.f,
+        "Swordsman", "S",
+        false, 0.f, 0.f, 0, 0.f, 0.f, 0.f
+    },
+    {
+        iEntityStats::Mob, iEntityStats::Archer, iEntityStats::InvalidBuildingType,
+        2.f, 216, 5.f, 0.4f, 2.f, iEntityStats::Any, 6.5f, iEntityStats::Ranged, 100, 0.7f, 8.f,
+        "Archer", "A",
+        false, 0.f, 0.f, 0, 0.f, 0.f, 0.f
+    },
+    {
+        iEntityStats::Mob, iEntityStats::Giant, iEntityStats::InvalidBuildingType,
+        5.f, 3275, 2.f, 0.9f, 8.f, iEntityStats::Building, 0.5f, iEntityStats::Melee, 211, 1.5f, 3.f,
+        "Giant", "G",
+        false, 0.f, 0.f, 0, 0.f, 0.f, 0.f
+    },
+    {
+        iEntityStats::Mob, iEntityStats::Rogue, iEntityStats::InvalidBuildingType,
+        2.f, 500, 5.f, 0.4f, 2.f, iEntityStats::Mob, 0.2f, iEntityStats::Melee, 100, 0.5f, 10.f,
+        "Rogue", "R",
+        true, 2.5f, 15.f, 1000, 2.f, 0.5f, 2.f
+    },
+};
+
+// NOTE: The rows must be in the same order as the BuildingType enum.  
+// Buildings don't cost elixir or move, and they all do ranged attacks.
+constexpr EntityStatsData BUILDING_STATS[iEntityStats::numBuildingTypes] =
+{
+    {
+        iEntityStats::Building, iEntityStats::InvalidMobType, iEntityStats::Princess,
+        FLT_MAX, 2534, FLT_MAX, 2.5f, FLT_MAX, iEntityStats::Any, 7.5f, iEntityStats::Ranged, 90, 0.8f, 8.f,
+        "Princess Tower", "P",
+        false, 0.f, 0.f, 0, 0.f, 0.f, 0.f
+    },
+    {
+        iEntityStats::Building, iEntityStats::InvalidMobType, iEntityStats::King,
+        FLT_MAX, 4008, FLT_MAX, 3.5f, FLT_MAX, iEntityStats::Any, 7.f, iEntityStats::Ranged, 90, 1.f, 8.f,
+        "King Tower", "K",
+        false, 0.f, 0.f, 0, 0.f, 0.f, 0.f
+    },
+};
+
+static_assert(sizeof(MOB_STATS) / sizeof(MOB_STATS[0]) == iEntityStats::numMobTypes,
+              "MOB_STATS is out of synch with the MobType enum");
+static_assert(sizeof(BUILDING_STATS) / sizeof(BUILDING_STATS[0]) == iEntityStats::numBuildingTypes,
+              "BUILDING_STATS is out of synch with the BuildingType enum");
+static_assert((MOB_STATS[iEntityStats::Swordsman].m_MobType == iEntityStats::Swordsman) &&
+              (MOB_STATS[iEntityStats::Archer].m_MobType == iEntityStats::Archer) &&
+              (MOB_STATS[iEntityStats::Giant].m_MobType == iEntityStats::Giant) &&
+              (MOB_STATS[iEntityStats::Rogue].m_MobType == iEntityStats::Rogue),
+              "MOB_STATS rows are out of order");
+static_assert((BUILDING_STATS[iEntityStats::Princess].m_BuildingType == iEntityStats::Princess) &&
+              (BUILDING_STATS[iEntityStats::King].m_BuildingType == iEntityStats::King),
+              "BUILDING_STATS rows are out of order");
+
+// Gets the table row for a (valid) mob or building stats object.
+inline const EntityStatsData& lookupStatsData(const iEntityStats& stats)
+{
+    if (stats.getType() == iEntityStats::Building)
+    {
+        assert(stats.getBuildingType() < iEntityStats::numBuildingTypes);
+        return BUILDING_STATS[stats.getBuildingType()];
+    }
+
+    assert(stats.getMobType() < iEntityStats::numMobTypes);
+    return MOB_STATS[stats.getMobType()];
+}
@@ -33,6 +33,8 @@
 
 class iEntity;
 class iOpposingEntity;
+class iSandbox;
+struct GameSnapshot;
 
 class iPlayer 
 {
@@ -64,6 +66,7 @@ public:
         InvalidX,
         InvalidY,
         MobTypeUnavailable,
+        TooManyMobs,            // you already have MAX_MOBS_PER_PLAYER mobs
     };
     virtual PlacementResult placeMob(iEntityStats::MobType type, const Vec2& pos) = 0;
 
@@ -71,6 +74,10 @@ public:
     // the opposing player's entities.
     // NOTE: When getting buildings or mobs, you are responsible for ensuring you pass
     // in a valid index, but if you don't I'll create an invalid one for you.
+    // NOTE: The references in EntityData point into the game's entity storage,
+    // which moves around as mobs are placed and die.  Don't hang on to them
+    // past the current tick (or your next call to placeMob()) - copy the 
+    // values out instead.
     struct EntityData
     {
         const iEntityStats& m_Stats;
@@ -92,6 +99,14 @@ public:
     virtual unsigned int getNumOpponentMobs() const = 0;
     virtual EntityData getOpponentMob(unsigned int i) const = 0;
 
+    // Final Project: Use these to look ahead.  takeSnapshot() copies the whole
+    // game (both players) into outSnapshot, and createSandbox() makes a new,
+    // empty game that you can restore snapshots into and play forward.  See
+    // GameSnapshot.h and iSandbox.h.
+    // NOTE: you own the sandbox, and must delete it.
+    virtual void takeSnapshot(GameSnapshot& outSnapshot) const = 0;
+    virtual iSandbox* createSandbox() const = 0;
+
 private:
     // DELIBERATELY UNDEFINED
     iPlayer(const iPlayer& rhs);
@@ -0,0 +1,69 @@
+// MIT License
+// 
+// Copyright(c) 2020 Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Final Project: A sandbox is a private game that you can restore a snapshot
+// into and then play forward, to see what would happen - which is the heart 
+// of any search-based AI.  Nothing you do in a sandbox affects the real game.
+// The sandbox has no controllers, so nobody places mobs in it but you (via 
+// placeMob() below), and it never logs anything.
+//   Sandboxes are fairly big (they have room for every mob a game can hold),
+// so make one per thread and restore() into it over and over, rather than 
+// making a new one for every lookahead.  Different sandboxes can be used on 
+// different threads at the same time.
+
+#include "iPlayer.h"
+
+struct GameSnapshot;
+
+class iSandbox
+{
+public:
+    iSandbox() {}
+    virtual ~iSandbox() {}
+
+    // Throws away the sandbox's current state, and replaces it with the 
+    // snapshot.
+    virtual void restore(const GameSnapshot& snapshot) = 0;
+
+    // Captures the sandbox's current state.
+    virtual void takeSnapshot(GameSnapshot& outSnapshot) const = 0;
+
+    // Places a mob for either player, just as iPlayer::placeMob() does.
+    virtual iPlayer::PlacementResult placeMob(bool bNorth, iEntityStats::MobType type, const Vec2& pos) = 0;
+
+    // Advances the simulation by one tick.
+    virtual void tick(float deltaTSec) = 0;
+
+    // Negative => South won, Positive => North won, 0 => no winner yet
+    virtual int checkGameOver() = 0;
+
+    // Use these to look at the state of the sandbox.  The EntityData that 
+    // they hand out are only good until the sandbox is changed.
+    virtual const iPlayer& getPlayer(bool bNorth) const = 0;
+
+private:
+    // DELIBERATELY UNDEFINED
+    iSandbox(const iSandbox& rhs);
+    iSandbox& operator=(const iSandbox& rhs);
+};